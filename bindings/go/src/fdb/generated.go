@@ -494,6 +494,11 @@ func (o TransactionOptions) SetReadLockAware() error {
 	return o.setOpt(702, nil)
 }
 
+// Reads performed by this transaction may be served from a client-side cache shared by all transactions on the database that set this option. A cached result is only used when the value of the ``\xff/metadataVersion`` key at the transaction's read version is the same as when the result was read, so every transaction that modifies data read with this option must also update ``\xff/metadataVersion``. Only reads of individual keys and of ranges bounded by ``first_greater_or_equal`` key selectors are cached.
+func (o TransactionOptions) SetUseMetadataCache() error {
+	return o.setOpt(703, nil)
+}
+
 // This option should only be used by tools which change the database configuration.
 func (o TransactionOptions) SetUseProvisionalProxies() error {
 	return o.setOpt(711, nil)
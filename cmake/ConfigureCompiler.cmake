@@ -12,6 +12,7 @@ set(USE_CCACHE OFF CACHE BOOL "Use ccache for compilation if available")
 set(RELATIVE_DEBUG_PATHS OFF CACHE BOOL "Use relative file paths in debug info")
 set(STATIC_LINK_LIBCXX ON CACHE BOOL "Statically link libstdcpp/libc++")
 set(USE_WERROR OFF CACHE BOOL "Compile with -Werror. Recommended for local development and CI.")
+set(ACTOR_PROFILING OFF CACHE BOOL "Have the actor compiler instrument actors with per-actor CPU and allocation counters")
 
 set(rel_debug_paths OFF)
 if(RELATIVE_DEBUG_PATHS)
@@ -35,6 +36,9 @@ endif()
 if(DEBUG_TASKS)
   add_compile_options(-DDEBUG_TASKS)
 endif()
+if(ACTOR_PROFILING)
+  add_compile_options(-DENABLE_ACTOR_PROFILING)
+endif()
 
 if(NDEBUG)
   add_compile_options(-DNDEBUG)
@@ -170,6 +170,9 @@ function(add_flow_target)
       if(${src} MATCHES ".*\\.actor\\.(h|cpp)")
         list(APPEND actors ${src})
         list(APPEND actor_compiler_flags "--generate-probes")
+        if(ACTOR_PROFILING)
+          list(APPEND actor_compiler_flags "--generate-profiling")
+        endif()
         if(${src} MATCHES ".*\\.h")
           string(REPLACE ".actor.h" ".actor.g.h" generated ${src})
         else()
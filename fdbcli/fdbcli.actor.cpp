@@ -3124,7 +3124,7 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 
 				if (tokencmp(tokens[0], "profile")) {
 					if (tokens.size() == 1) {
-						printf("ERROR: Usage: profile <client|list|flow|heap>\n");
+						printf("ERROR: Usage: profile <client|list|flow|actor|heap>\n");
 						is_error = true;
 						continue;
 					}
@@ -3220,15 +3220,18 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 						}
 						continue;
 					}
-					if (tokencmp(tokens[1], "flow")) {
+					if (tokencmp(tokens[1], "flow") || tokencmp(tokens[1], "actor")) {
+						// `profile actor' dumps the per-actor run counts, CPU and arena bytes accumulated over the
+						// run instead of a sampled flow profile.  It requires binaries built with ACTOR_PROFILING.
+						state ProfilerRequest::Type profilerType = tokencmp(tokens[1], "actor") ? ProfilerRequest::Type::ACTORS : ProfilerRequest::Type::FLOW;
 						if (tokens.size() == 2) {
-							printf("ERROR: Usage: profile flow <run>\n");
+							printf("ERROR: Usage: profile %s <run>\n", printable(tokens[1]).c_str());
 							is_error = true;
 							continue;
 						}
 						if (tokencmp(tokens[2], "run")) {
 							if (tokens.size() < 6) {
-								printf("ERROR: Usage: profile flow run <duration in seconds> <filename> <hosts>\n");
+								printf("ERROR: Usage: profile %s run <duration in seconds> <filename> <hosts>\n", printable(tokens[1]).c_str());
 								is_error = true;
 								continue;
 							}
@@ -3253,7 +3256,7 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 							}
 							if (tokens.size() == 6 && tokencmp(tokens[5], "all")) {
 								for (const auto& pair : interfaces) {
-									ProfilerRequest profileRequest(ProfilerRequest::Type::FLOW, ProfilerRequest::Action::RUN, duration);
+									ProfilerRequest profileRequest(profilerType, ProfilerRequest::Action::RUN, duration);
 									profileRequest.outputFile = tokens[4];
 									all_profiler_addresses.push_back(pair.first);
 									all_profiler_responses.push_back(pair.second.profiler.tryGetReply(profileRequest));
@@ -3268,7 +3271,7 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 								}
 								if (!is_error) {
 									for (int tokenidx = 5; tokenidx < tokens.size(); tokenidx++) {
-										ProfilerRequest profileRequest(ProfilerRequest::Type::FLOW, ProfilerRequest::Action::RUN, duration);
+										ProfilerRequest profileRequest(profilerType, ProfilerRequest::Action::RUN, duration);
 										profileRequest.outputFile = tokens[4];
 										all_profiler_addresses.push_back(tokens[tokenidx]);
 										all_profiler_responses.push_back(interfaces[tokens[tokenidx]].profiler.tryGetReply(profileRequest));
@@ -3281,6 +3284,10 @@ ACTOR Future<int> cli(CLIOptions opt, LineNoise* plinenoise) {
 									const ErrorOr<Void>& err = all_profiler_responses[i].get();
 									if (err.isError()) {
 										printf("ERROR: %s: %s: %s\n", printable(all_profiler_addresses[i]).c_str(), err.getError().name(), err.getError().what());
+										if (err.getError().code() == error_code_unsupported_operation && profilerType == ProfilerRequest::Type::ACTORS) {
+											printf("  The process was not built with ACTOR_PROFILING.\n");
+										}
+										is_error = true;
 									}
 								}
 							}
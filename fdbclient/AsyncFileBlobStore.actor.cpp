@@ -80,3 +80,67 @@ TEST_CASE("/backup/throttling") {
 }
 
 
+
+// Stands in for a blob store object when measuring read ahead.  Every read takes the same time regardless of its size,
+// like a ranged GET whose cost is dominated by request latency, and returns bytes derived from their offset.
+class FixedLatencyReadFile : public IAsyncFile, public ReferenceCounted<FixedLatencyReadFile> {
+public:
+	FixedLatencyReadFile(int64_t size, double latency) : m_size(size), m_latency(latency) {}
+
+	virtual void addref() { ReferenceCounted<FixedLatencyReadFile>::addref(); }
+	virtual void delref() { ReferenceCounted<FixedLatencyReadFile>::delref(); }
+
+	ACTOR static Future<int> read_impl(Reference<FixedLatencyReadFile> f, uint8_t* data, int length, int64_t offset) {
+		wait(delay(f->m_latency));
+		int len = std::max<int64_t>(0, std::min<int64_t>(length, f->m_size - offset));
+		for(int i = 0; i < len; ++i)
+			data[i] = (uint8_t)(offset + i);
+		return len;
+	}
+
+	virtual Future<int> read(void* data, int length, int64_t offset) {
+		return read_impl(Reference<FixedLatencyReadFile>::addRef(this), (uint8_t*)data, length, offset);
+	}
+	virtual Future<Void> write(void const* data, int length, int64_t offset) { throw file_not_writable(); }
+	virtual Future<Void> truncate(int64_t size) { throw file_not_writable(); }
+	virtual Future<Void> sync() { return Void(); }
+	virtual Future<int64_t> size() { return m_size; }
+	virtual int64_t debugFD() { return -1; }
+	virtual std::string getFilename() { return "FixedLatencyReadFile"; }
+
+private:
+	int64_t m_size;
+	double m_latency;
+};
+
+ACTOR Future<double> timeSequentialRead(Reference<IAsyncFile> f, int readSize) {
+	state double ts = now();
+	state Standalone<StringRef> buf = makeString(readSize);
+	state int64_t fileSize = wait(f->size());
+	state int64_t offset = 0;
+	while(offset < fileSize) {
+		int len = wait(f->read(mutateString(buf), readSize, offset));
+		ASSERT(len > 0);
+		for(int i = 0; i < len; ++i)
+			ASSERT(buf[i] == (uint8_t)(offset + i));
+		offset += len;
+	}
+	return now() - ts;
+}
+
+TEST_CASE("/backup/read_ahead_parallelism") {
+	state int blockSize = 100000;
+	state int blocks = 20;
+	state double latency = 0.01;
+	state Reference<IAsyncFile> object(new FixedLatencyReadFile((int64_t)blockSize * blocks, latency));
+
+	// Restore reads log and range files sequentially in pieces smaller than a block
+	state double serial = wait(timeSequentialRead(Reference<IAsyncFile>(new AsyncFileReadAheadCache(object, blockSize, 0, 1, 1)), blockSize / 3));
+	state double parallel = wait(timeSequentialRead(Reference<IAsyncFile>(new AsyncFileReadAheadCache(object, blockSize, 3, 4, 1)), blockSize / 3));
+
+	printf("Read %d blocks with %fs request latency: %fs without read ahead, %fs with 3 blocks of read ahead\n", blocks, latency, serial, parallel);
+	ASSERT(serial >= blocks * latency);
+	ASSERT(parallel < serial / 2);
+
+	return Void();
+}
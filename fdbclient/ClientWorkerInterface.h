@@ -72,6 +72,7 @@ struct ProfilerRequest {
 		GPROF = 1,
 		FLOW = 2,
 		GPROF_HEAP = 3,
+		ACTORS = 4,
 	};
 
 	enum class Action : std::int8_t {
@@ -45,6 +45,31 @@ private:
 typedef MultiInterface<ReferencedInterface<StorageServerInterface>> LocationInfo;
 typedef MultiInterface<MasterProxyInterface> ProxyInfo;
 
+// Caches the results of reads made by transactions with the USE_METADATA_CACHE option. All entries were read at versions with
+// the same value of \xff/metadataVersion, and are only returned to transactions whose read version has that value.
+class MetadataCache {
+public:
+	MetadataCache() : bytes(0) {}
+
+	// Returns the contents of keys if they are covered by the cache at the given metadata version
+	Optional<Standalone<RangeResultRef>> get(Optional<Value> const& metadataVersion, KeyRangeRef const& keys) const;
+
+	// Caches the complete, ordered contents of keys read at the given metadata version
+	void insert(Optional<Value> const& metadataVersion, KeyRangeRef const& keys, Standalone<RangeResultRef> const& data);
+
+	int64_t getBytes() const { return bytes; }
+
+private:
+	struct Entry {
+		Key end;
+		Standalone<RangeResultRef> data;
+	};
+
+	Optional<Optional<Value>> metadataVersion; // Not present until the first insert
+	std::map<Key, Entry> entries; // Non-overlapping ranges, by begin key
+	int64_t bytes;
+};
+
 class DatabaseContext : public ReferenceCounted<DatabaseContext>, public FastAllocated<DatabaseContext>, NonCopyable {
 public:
 	static DatabaseContext* allocateOnForeignThread() {
@@ -173,6 +198,8 @@ public:
 	Counter transactionsResourceConstrained;
 	Counter transactionsProcessBehind;
 	Counter transactionsThrottled;
+	Counter transactionMetadataCacheHits;
+	Counter transactionMetadataCacheMisses;
 
 	ContinuousSample<double> latencies, readLatencies, commitLatencies, GRVLatencies, mutationsPerCommit, bytesPerCommit;
 
@@ -200,6 +227,7 @@ public:
 
 	int mvCacheInsertLocation;
 	std::vector<std::pair<Version, Optional<Value>>> metadataVersionCache;
+	MetadataCache metadataCache;
 
 	HealthMetrics healthMetrics;
 	double healthMetricsLastUpdated;
@@ -65,6 +65,7 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	init( VALUE_SIZE_LIMIT,                        1e5 );
 	init( SPLIT_KEY_SIZE_LIMIT,                    KEY_SIZE_LIMIT/2 ); if( randomize && BUGGIFY ) SPLIT_KEY_SIZE_LIMIT = KEY_SIZE_LIMIT - 31;//serverKeysPrefixFor(UID()).size() - 1;
 	init( METADATA_VERSION_CACHE_SIZE,            1000 );
+	init( METADATA_CACHE_BYTES,                   10e6 ); if( randomize && BUGGIFY ) METADATA_CACHE_BYTES = 1000;
 
 	init( MAX_BATCH_SIZE,                         1000 ); if( randomize && BUGGIFY ) MAX_BATCH_SIZE = 1;
 	init( GRV_BATCH_TIMEOUT,                     0.005 ); if( randomize && BUGGIFY ) GRV_BATCH_TIMEOUT = 0.1;
@@ -175,8 +176,8 @@ ClientKnobs::ClientKnobs(bool randomize) {
 	init( BLOBSTORE_CONCURRENT_WRITES_PER_FILE,      5 );
 	init( BLOBSTORE_CONCURRENT_READS_PER_FILE,       3 );
 	init( BLOBSTORE_READ_BLOCK_SIZE,       1024 * 1024 );
-	init( BLOBSTORE_READ_AHEAD_BLOCKS,               0 );
-	init( BLOBSTORE_READ_CACHE_BLOCKS_PER_FILE,      2 );
+	init( BLOBSTORE_READ_AHEAD_BLOCKS,               2 );
+	init( BLOBSTORE_READ_CACHE_BLOCKS_PER_FILE,      4 );
 	init( BLOBSTORE_MULTIPART_MAX_PART_SIZE,  20000000 );
 	init( BLOBSTORE_MULTIPART_MIN_PART_SIZE,   5242880 );
 
@@ -508,7 +508,8 @@ DatabaseContext::DatabaseContext(Reference<AsyncVar<Reference<ClusterConnectionF
     transactionsCommitCompleted("CommitCompleted", cc), transactionsTooOld("TooOld", cc),
     transactionsFutureVersions("FutureVersions", cc), transactionsNotCommitted("NotCommitted", cc),
     transactionsMaybeCommitted("MaybeCommitted", cc), transactionsResourceConstrained("ResourceConstrained", cc),
-    transactionsThrottled("Throttled", cc), transactionsProcessBehind("ProcessBehind", cc), outstandingWatches(0),
+    transactionsThrottled("Throttled", cc), transactionsProcessBehind("ProcessBehind", cc),
+    transactionMetadataCacheHits("MetadataCacheHits", cc), transactionMetadataCacheMisses("MetadataCacheMisses", cc), outstandingWatches(0),
     latencies(1000), readLatencies(1000), commitLatencies(1000), GRVLatencies(1000), mutationsPerCommit(1000),
     bytesPerCommit(1000), mvCacheInsertLocation(0), healthMetricsLastUpdated(0), detailedHealthMetricsLastUpdated(0),
     internal(internal) {
@@ -540,7 +541,8 @@ DatabaseContext::DatabaseContext(const Error& err)
     transactionsCommitCompleted("CommitCompleted", cc), transactionsTooOld("TooOld", cc),
     transactionsFutureVersions("FutureVersions", cc), transactionsNotCommitted("NotCommitted", cc),
     transactionsMaybeCommitted("MaybeCommitted", cc), transactionsResourceConstrained("ResourceConstrained", cc),
-    transactionsThrottled("Throttled", cc), transactionsProcessBehind("ProcessBehind", cc), latencies(1000),
+    transactionsThrottled("Throttled", cc), transactionsProcessBehind("ProcessBehind", cc),
+    transactionMetadataCacheHits("MetadataCacheHits", cc), transactionMetadataCacheMisses("MetadataCacheMisses", cc), latencies(1000),
     readLatencies(1000), commitLatencies(1000), GRVLatencies(1000), mutationsPerCommit(1000), bytesPerCommit(1000),
     internal(false) {}
 
@@ -2046,6 +2048,137 @@ void Transaction::setVersion( Version v ) {
 	readVersion = v;
 }
 
+Optional<Standalone<RangeResultRef>> MetadataCache::get(Optional<Value> const& metadataVersion, KeyRangeRef const& keys) const {
+	if(!this->metadataVersion.present() || this->metadataVersion.get() != metadataVersion) {
+		return Optional<Standalone<RangeResultRef>>();
+	}
+
+	auto it = entries.upper_bound(keys.begin);
+	if(it == entries.begin()) {
+		return Optional<Standalone<RangeResultRef>>();
+	}
+	--it;
+	if(it->second.end < keys.end) {
+		return Optional<Standalone<RangeResultRef>>();
+	}
+
+	Standalone<RangeResultRef> result;
+	result.arena().dependsOn(it->second.data.arena());
+	auto const& data = it->second.data;
+	auto begin = std::lower_bound(data.begin(), data.end(), keys.begin, KeyValueRef::OrderByKey());
+	auto end = std::lower_bound(begin, data.end(), keys.end, KeyValueRef::OrderByKey());
+	result.append(result.arena(), begin, end - begin);
+	return result;
+}
+
+void MetadataCache::insert(Optional<Value> const& metadataVersion, KeyRangeRef const& keys, Standalone<RangeResultRef> const& data) {
+	if(this->metadataVersion.present() && this->metadataVersion.get() != metadataVersion) {
+		// Entries read at an older metadata version are never useful again, but an insert for an older version is not useful either
+		if(metadataVersion.present() && (!this->metadataVersion.get().present() || metadataVersion.get() > this->metadataVersion.get().get())) {
+			entries.clear();
+			bytes = 0;
+		} else {
+			return;
+		}
+	}
+	this->metadataVersion = metadataVersion;
+
+	int64_t size = keys.expectedSize() + data.expectedSize();
+	if(size > CLIENT_KNOBS->METADATA_CACHE_BYTES) {
+		return;
+	}
+	if(bytes + size > CLIENT_KNOBS->METADATA_CACHE_BYTES) {
+		entries.clear();
+		bytes = 0;
+	}
+
+	// Remove the entries overlapping keys
+	auto it = entries.lower_bound(keys.begin);
+	if(it != entries.begin() && std::prev(it)->second.end > keys.begin) {
+		--it;
+	}
+	while(it != entries.end() && it->first < keys.end) {
+		bytes -= it->first.expectedSize() + it->second.end.expectedSize() + it->second.data.expectedSize();
+		it = entries.erase(it);
+	}
+
+	Entry& e = entries[keys.begin];
+	e.end = keys.end;
+	e.data = data;
+	bytes += size;
+}
+
+ACTOR Future<Optional<Value>> getValueFromMetadataCache( Future<Version> version, Future<Optional<Value>> fMetadataVersion, Key key, Database cx, TransactionInfo info, Reference<TransactionLogInfo> trLogInfo ) {
+	state Optional<Value> metadataVersion = wait( fMetadataVersion );
+	state KeyRange keys = singleKeyRange(key);
+
+	Optional<Standalone<RangeResultRef>> cached = cx->metadataCache.get(metadataVersion, keys);
+	if(cached.present()) {
+		++cx->transactionMetadataCacheHits;
+		if(cached.get().size()) {
+			return Value(cached.get()[0].value, cached.get().arena());
+		}
+		return Optional<Value>();
+	}
+
+	++cx->transactionMetadataCacheMisses;
+	Optional<Value> value = wait( getValue(version, key, cx, info, trLogInfo) );
+	Standalone<RangeResultRef> data;
+	if(value.present()) {
+		data.push_back_deep(data.arena(), KeyValueRef(key, value.get()));
+	}
+	cx->metadataCache.insert(metadataVersion, keys, data);
+	return value;
+}
+
+ACTOR Future<Standalone<RangeResultRef>> getRangeFromMetadataCache( Database cx, Reference<TransactionLogInfo> trLogInfo, Future<Version> version,
+	Future<Optional<Value>> fMetadataVersion, KeyRange keys, GetRangeLimits limits, Promise<std::pair<Key, Key>> conflictRange, bool snapshot, bool reverse,
+	TransactionInfo info )
+{
+	state Optional<Value> metadataVersion = wait( fMetadataVersion );
+
+	Optional<Standalone<RangeResultRef>> cached = cx->metadataCache.get(metadataVersion, keys);
+	if(cached.present()) {
+		++cx->transactionMetadataCacheHits;
+		Standalone<RangeResultRef> result;
+		result.arena().dependsOn(cached.get().arena());
+		int n = cached.get().size();
+		for(int i = 0; i < n && !limits.isReached(); i++) {
+			KeyValueRef const& kv = cached.get()[reverse ? n-1-i : i];
+			result.push_back(result.arena(), kv);
+			limits.decrement(kv);
+		}
+		result.more = result.size() < n;
+
+		// The read conflict range covers only the part of keys which was returned
+		if(result.more) {
+			if(reverse) {
+				conflictRange.send(std::make_pair(Key(result.end()[-1].key, result.arena()), keys.end));
+			} else {
+				conflictRange.send(std::make_pair(keys.begin, keyAfter(result.end()[-1].key)));
+			}
+		} else {
+			conflictRange.send(std::make_pair(keys.begin, keys.end));
+		}
+		return result;
+	}
+
+	++cx->transactionMetadataCacheMisses;
+	Standalone<RangeResultRef> result = wait( getRange(cx, trLogInfo, version, firstGreaterOrEqual(keys.begin), firstGreaterOrEqual(keys.end), limits, conflictRange, snapshot, reverse, info) );
+	if(!result.more) {
+		Standalone<RangeResultRef> data = result;
+		if(reverse) {
+			data = Standalone<RangeResultRef>();
+			data.arena().dependsOn(result.arena());
+			for(int i = result.size() - 1; i >= 0; i--) {
+				data.push_back(data.arena(), result[i]);
+			}
+		}
+		cx->metadataCache.insert(metadataVersion, keys, data);
+	}
+	return result;
+}
+
 Future<Optional<Value>> Transaction::get( const Key& key, bool snapshot ) {
 	++cx->transactionLogicalReads;
 	//ASSERT (key < allKeys.end);
@@ -2063,36 +2196,47 @@ Future<Optional<Value>> Transaction::get( const Key& key, bool snapshot ) {
 		tr.transaction.read_conflict_ranges.push_back(tr.arena, singleKeyRange(key, tr.arena));
 
 	if(key == metadataVersionKey) {
-		if(!ver.isReady() || metadataVersion.isSet()) {
-			return metadataVersion.getFuture();
-		} else {
-			if(ver.isError()) return ver.getError();
-			if(ver.get() == cx->metadataVersionCache[cx->mvCacheInsertLocation].first) {
-				return cx->metadataVersionCache[cx->mvCacheInsertLocation].second;
-			}
+		return getMetadataVersion(ver);
+	}
 
-			Version v = ver.get();
-			int hi = cx->mvCacheInsertLocation;
-			int lo = (cx->mvCacheInsertLocation+1)%cx->metadataVersionCache.size();
+	if(options.useMetadataCache) {
+		return getValueFromMetadataCache(ver, getMetadataVersion(ver), key, cx, info, trLogInfo);
+	}
 
-			while(hi!=lo) {
-				int cu = hi > lo ? (hi + lo)/2 : ((hi + cx->metadataVersionCache.size() + lo)/2)%cx->metadataVersionCache.size();
-				if(v == cx->metadataVersionCache[cu].first) {
-					return cx->metadataVersionCache[cu].second;
-				}
-				if(cu == lo) {
-					break;
-				}
-				if(v < cx->metadataVersionCache[cu].first) {
-					hi = cu;
-				} else {
-					lo = (cu+1)%cx->metadataVersionCache.size();
-				}
+	return getValue( ver, key, cx, info, trLogInfo );
+}
+
+// Returns the value of metadataVersionKey at ver, using the version from the GRV reply or the cache of recent metadata versions when possible
+Future<Optional<Value>> Transaction::getMetadataVersion( Future<Version> const& ver ) {
+	if(!ver.isReady() || metadataVersion.isSet()) {
+		return metadataVersion.getFuture();
+	} else {
+		if(ver.isError()) return ver.getError();
+		if(ver.get() == cx->metadataVersionCache[cx->mvCacheInsertLocation].first) {
+			return cx->metadataVersionCache[cx->mvCacheInsertLocation].second;
+		}
+
+		Version v = ver.get();
+		int hi = cx->mvCacheInsertLocation;
+		int lo = (cx->mvCacheInsertLocation+1)%cx->metadataVersionCache.size();
+
+		while(hi!=lo) {
+			int cu = hi > lo ? (hi + lo)/2 : ((hi + cx->metadataVersionCache.size() + lo)/2)%cx->metadataVersionCache.size();
+			if(v == cx->metadataVersionCache[cu].first) {
+				return cx->metadataVersionCache[cu].second;
+			}
+			if(cu == lo) {
+				break;
+			}
+			if(v < cx->metadataVersionCache[cu].first) {
+				hi = cu;
+			} else {
+				lo = (cu+1)%cx->metadataVersionCache.size();
 			}
 		}
 	}
 
-	return getValue( ver, key, cx, info, trLogInfo );
+	return getValue( ver, metadataVersionKey, cx, info, trLogInfo );
 }
 
 void Watch::setWatch(Future<Void> watchFuture) {
@@ -2252,6 +2396,11 @@ Future< Standalone<RangeResultRef> > Transaction::getRange(
 		extraConflictRanges.push_back( conflictRange.getFuture() );
 	}
 
+	if(options.useMetadataCache && b.isFirstGreaterOrEqual() && e.isFirstGreaterOrEqual()) {
+		auto ver = getReadVersion();
+		return getRangeFromMetadataCache(cx, trLogInfo, ver, getMetadataVersion(ver), KeyRangeRef(b.getKey(), e.getKey()), limits, conflictRange, snapshot, reverse, info);
+	}
+
 	return ::getRange(cx, trLogInfo, getReadVersion(), b, e, limits, conflictRange, snapshot, reverse, info);
 }
 
@@ -2985,6 +3134,11 @@ void Transaction::setOption( FDBTransactionOptions::Option option, Optional<Stri
 			options.firstInBatch = true;
 			break;
 
+		case FDBTransactionOptions::USE_METADATA_CACHE:
+			validateOptionValue(value, false);
+			options.useMetadataCache = true;
+			break;
+
 		case FDBTransactionOptions::USE_PROVISIONAL_PROXIES:
 			validateOptionValue(value, false);
 			options.getReadVersionFlags |= GetReadVersionRequest::FLAG_USE_PROVISIONAL_PROXIES;
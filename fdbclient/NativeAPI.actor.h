@@ -133,6 +133,7 @@ struct TransactionOptions {
 	bool readOnly : 1;
 	bool firstInBatch : 1;
 	bool includePort : 1;
+	bool useMetadataCache : 1;
 
 	TransactionOptions(Database const& cx);
 	TransactionOptions();
@@ -300,6 +301,7 @@ public:
 private:
 	Future<Version> getReadVersion(uint32_t flags);
 	void setPriority(uint32_t priorityFlag);
+	Future<Optional<Value>> getMetadataVersion(Future<Version> const& ver);
 
 	Database cx;
 
@@ -557,6 +557,56 @@ TEST_CASE("/fdbclient/WriteMap/addValue") {
 	return Void();
 }
 
+TEST_CASE("/fdbclient/WriteMap/bulkSet") {
+	// Long runs of sets are merged into the tree in bulk; check that the result matches applying them one at a time
+	Arena arena = Arena();
+	WriteMap bulk = WriteMap(&arena);
+	WriteMap single = WriteMap(&arena);
+
+	for (int round = 0; round < 10; round++) {
+		for (int i = 0; i < 3; i++) {
+			KeyRangeRef range = RandomTestImpl::getRandomRange(arena);
+			int r = deterministicRandom()->randomInt(0, 4);
+			if (r == 0) {
+				bulk.addConflictRange(range);
+				single.addConflictRange(range);
+			} else if (r == 1) {
+				bulk.addUnmodifiedAndUnreadableRange(range);
+				single.addUnmodifiedAndUnreadableRange(range);
+			} else {
+				bool addConflict = r == 2;
+				bulk.clear(range, addConflict);
+				single.clear(range, addConflict);
+			}
+		}
+
+		int sets = deterministicRandom()->randomInt(0, 300);
+		for (int i = 0; i < sets; i++) {
+			bool addConflict = deterministicRandom()->random01() < 0.5;
+			KeyRef key = RandomTestImpl::getRandomKey(arena);
+			ValueRef value = RandomTestImpl::getRandomValue(arena);
+			bulk.mutate(key, MutationRef::SetValue, value, addConflict);
+			single.mutate(key, MutationRef::SetValue, value, addConflict);
+			WriteMap::iterator flush(&single);
+		}
+
+		WriteMap::iterator b(&bulk);
+		WriteMap::iterator s(&single);
+		b.skip(allKeys.begin);
+		s.skip(allKeys.begin);
+		for (; s.beginKey() < allKeys.end; ++b, ++s) {
+			ASSERT(b.beginKey() == s.beginKey() && b.endKey() == s.endKey());
+			ASSERT(b.type() == s.type());
+			ASSERT(b.is_conflict_range() == s.is_conflict_range());
+			ASSERT(b.is_unreadable() == s.is_unreadable());
+			ASSERT(!s.is_operation() || b.op() == s.op());
+		}
+		ASSERT(b.beginKey() >= allKeys.end);
+	}
+
+	return Void();
+}
+
 TEST_CASE("/fdbclient/WriteMap/random") {
 	Arena arena = Arena();
 	WriteMap writes = WriteMap(&arena);
@@ -286,6 +286,45 @@ public:
 			when (wait(ryw->resetPromise.getFuture())) { throw internal_error(); }
 		}
 	}
+	// A key that the transaction has neither written nor already read has to be read from the database, and reads the
+	// same as it does there, so there is nothing for RYWIterator to merge.  The value is still added to the snapshot
+	// cache, as read() would, so that later reads of the key in this transaction are answered from it.
+	ACTOR static Future<Optional<Value>> readWithConflictRangeUnwritten( ReadYourWritesTransaction* ryw, GetValueReq req, WriteMap::iterator it, bool snapshot ) {
+		choose {
+			when (Optional<Value> result = wait( ryw->tr.get( req.key, true ) )) {
+				KeyRef k( ryw->arena, req.key );
+				if( result.present() ) {
+					if( ryw->cache.insert( k, result.get() ) )
+						ryw->arena.dependsOn(result.get().arena());
+				} else {
+					ryw->cache.insert( k, Optional<ValueRef>() );
+				}
+				if(!snapshot)
+					ryw->updateConflictMap( req.key, it );
+				return result;
+			}
+			when (wait(ryw->resetPromise.getFuture())) { throw internal_error(); }
+		}
+	}
+	static inline Future<Optional<Value>> readWithConflictRange( ReadYourWritesTransaction* ryw, GetValueReq const& req, bool snapshot ) {
+		if (ryw->options.readYourWritesDisabled) {
+			return readWithConflictRangeThrough(ryw, req, snapshot);
+		} else if (snapshot && ryw->options.snapshotRywEnabled <= 0) {
+			return readWithConflictRangeSnapshot(ryw, req);
+		}
+
+		WriteMap::iterator it( &ryw->writes );
+		it.skip( req.key );
+		if( it.is_unmodified_range() && !it.is_unreadable() ) {
+			// Keys the cache knows (from an earlier get or getRange) are answered from it without a round trip
+			SnapshotCache::iterator cached( &ryw->cache, &ryw->writes );
+			cached.skip( req.key );
+			if( cached.is_unknown_range() ) {
+				return readWithConflictRangeUnwritten(ryw, req, it, snapshot);
+			}
+		}
+		return readWithConflictRangeRYW(ryw, req, snapshot);
+	}
 	template <class Req> static inline Future<typename Req::Result> readWithConflictRange( ReadYourWritesTransaction* ryw, Req const& req, bool snapshot ) {
 		if (ryw->options.readYourWritesDisabled) {
 			return readWithConflictRangeThrough(ryw, req, snapshot);
@@ -1453,12 +1492,12 @@ void ReadYourWritesTransaction::writeRangeToNativeTransaction(KeyRangeRef const&
 
 		//SOMEDAY: make atomicOp take set to avoid switch
 		if( it.is_operation() ) {
-			auto op = it.op();
+			auto const& op = it.op();
 			for( int i = 0; i < op.size(); ++i) {
-				switch(op[i].type) {
+				switch(op.at(i).type) {
 					case MutationRef::SetValue:
-						if (op[i].value.present()) {
-							tr.set(it.beginKey().assertRef(), op[i].value.get(), false);
+						if (op.at(i).value.present()) {
+							tr.set(it.beginKey().assertRef(), op.at(i).value.get(), false);
 						} else {
 							tr.clear(it.beginKey().assertRef(), false);
 						}
@@ -1477,7 +1516,7 @@ void ReadYourWritesTransaction::writeRangeToNativeTransaction(KeyRangeRef const&
 					case MutationRef::MinV2:
 					case MutationRef::AndV2:
 					case MutationRef::CompareAndClear:
-						tr.atomicOp(it.beginKey().assertRef(), op[i].value.get(), op[i].type, false);
+						tr.atomicOp(it.beginKey().assertRef(), op.at(i).value.get(), op.at(i).type, false);
 						break;
 					default:
 						break;
@@ -362,6 +362,16 @@ const KeyRef JSONSchemas::statusSchema = LiteralStringRef(R"statusSchema(
          "log_hit_rate":0.5,
          "storage_hit_rate":0.5
       },
+      "request_latencies":[
+         {
+            "request_type":"GetValueRequest",
+            "count":0,
+            "p50_seconds":0.0,
+            "p99_seconds":0.0,
+            "p999_seconds":0.0,
+            "buckets":"0:1 12:4"
+         }
+      ],
       "messages":[
          {
             "reasons":[
@@ -42,6 +42,11 @@ struct Tuple {
 
 	StringRef pack() const { return StringRef(data.begin(), data.size()); }
 
+	// Append the packed form of a single element to out, allocating from arena only if out does not already have the
+	// capacity for it.  These build keys directly in memory the caller owns, without a Tuple or its offsets.
+	static void packInto(Arena& arena, VectorRef<uint8_t>& out, StringRef const& str, bool utf8 = false);
+	static void packInto(Arena& arena, VectorRef<uint8_t>& out, int64_t value);
+
 	template <typename T>
 	Tuple& operator<<(T const& t) {
 		return append(t);
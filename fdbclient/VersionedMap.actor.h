@@ -49,5 +49,29 @@ Future<Void> deferredCleanupActor( std::vector<Tree> toFree, TaskPriority taskID
 	return Void();
 }
 
+// Compacts (see PTreeImpl::compact) every node of the tree rooted at root as of newOldestVersion, yielding every
+// nodesPerYield nodes.  The tree may be modified at newer versions while this runs.
+ACTOR template <class Tree, class Version>
+Future<Void> compactActor( Tree root, Version newOldestVersion, int nodesPerYield, TaskPriority taskID ) {
+	state std::vector<Tree> toCompact;
+	state int compactCount = 0;
+	if (root) toCompact.push_back(root);
+	while (!toCompact.empty()) {
+		Tree a = std::move( toCompact.back() );
+		toCompact.pop_back();
+
+		a->compact(newOldestVersion);
+		for(int c=0; c<2; c++) {
+			Tree child = a->child(c, newOldestVersion);
+			if (child) toCompact.push_back( std::move(child) );
+		}
+
+		if(++compactCount % nodesPerYield == 0)
+			wait( yield(taskID) );
+	}
+
+	return Void();
+}
+
 #include "flow/unactorcompiler.h"
 #endif
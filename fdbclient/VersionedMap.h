@@ -57,6 +57,16 @@ namespace PTreeImpl {
 		Reference<PTree> left(Version at) const { return child(false, at); }
 		Reference<PTree> right(Version at) const { return child(true, at); }
 
+		// If the node was updated at or before the given version, make the update permanent so that the child it
+		// replaced can be freed.  Reads at versions before the update will no longer see the old child.
+		void compact(Version newOldestVersion) {
+			if (updated && lastUpdateVersion <= newOldestVersion) {
+				pointer[replacedPointer] = pointer[2];
+				updated = false;
+				pointer[2] = Reference<PTree>();
+			}
+		}
+
 		PTree(const T& data, Version ver) : data(data), lastUpdateVersion(ver), updated(false) {
 			priority = deterministicRandom()->randomUInt32();
 		}
@@ -221,6 +231,25 @@ namespace PTreeImpl {
 		}
 	}
 
+	// Returns a PTree holding the given items, which must be sorted and distinct, in linear time.  Nodes get random
+	// priorities as in insert(), so the result has the same shape as if the items had been inserted one at a time.
+	template<class T>
+	Reference<PTree<T>> buildSorted(std::vector<T> const& items, Version at) {
+		std::vector<Reference<PTree<T>>> spine; // The right spine of the tree built so far, from the root down
+		for (auto const& x : items) {
+			Reference<PTree<T>> node(new PTree<T>(x, at));
+			Reference<PTree<T>> below;
+			while (spine.size() && spine.back()->priority < node->priority) {
+				below = spine.back();
+				spine.pop_back();
+			}
+			node->pointer[0] = below;
+			if (spine.size()) spine.back()->pointer[1] = node;
+			spine.push_back(node);
+		}
+		return spine.size() ? spine[0] : Reference<PTree<T>>();
+	}
+
 	template<class T>
 	Reference<PTree<T>> firstNode(const Reference<PTree<T>>& p, Version at) {
 		if (!p) ASSERT(false);
@@ -473,14 +502,7 @@ namespace PTreeImpl {
 		if (!p) {
 			return;
 		}
-		if (p->updated && p->lastUpdateVersion <= newOldestVersion) {
-			/* If the node has been updated, figure out which pointer was repalced. And delete that pointer */
-			auto which = p->replacedPointer;
-			p->pointer[which] = p->pointer[2];
-			p->updated = false;
-			p->pointer[2] = Reference<PTree<T>>();
-			//p->pointer[which] = Reference<PTree<T>>();
-		}
+		p->compact(newOldestVersion);
 		Reference<PTree<T>> left = p->left(newOldestVersion);
 		Reference<PTree<T>> right = p->right(newOldestVersion);
 		compact(left, newOldestVersion);
@@ -659,6 +681,13 @@ public:
 		//PTreeImpl::printTreeDetails(roots.back().second(), 0);
 	}
 
+	// An incremental alternative to compact(oldestVersion), to be called after forgetVersionsBefore().  Every node
+	// that is still reachable is either reachable from the root at oldestVersion or was created after it, so only that
+	// tree is walked, and the walk yields every nodesPerYield nodes.
+	Future<Void> compactAsync(int nodesPerYield, TaskPriority taskID = TaskPriority::DefaultYield) {
+		return compactActor(getRoot(oldestVersion), oldestVersion, nodesPerYield, taskID);
+	}
+
 	// for(auto i = vm.at(version).lower_bound(range.begin); i < range.end; ++i)
 	struct iterator{
 		explicit iterator(Tree const& root, Version at) : root(root), at(at) {}
@@ -122,65 +122,33 @@ private:
 	typedef Reference<PTreeT> Tree;
 
 public:
-	explicit WriteMap(Arena* arena) : arena(arena), ver(-1), scratch_iterator(this), writeMapEmpty(true)  {
+	explicit WriteMap(Arena* arena) : arena(arena), ver(-1), pendingSorted(true), approxEntries(3), scratch_iterator(this), writeMapEmpty(true)  {
 		PTreeImpl::insert( writes, ver, WriteMapEntry( allKeys.begin, OperationStack(), false, false, false, false, false ) );
 		PTreeImpl::insert( writes, ver, WriteMapEntry( allKeys.end, OperationStack(), false, false, false, false, false ) );
 		PTreeImpl::insert( writes, ver, WriteMapEntry( afterAllKeys, OperationStack(), false, false, false, false, false ) );
 	}
 
-	WriteMap(WriteMap&& r) BOOST_NOEXCEPT : writeMapEmpty(r.writeMapEmpty), writes(std::move(r.writes)), ver(r.ver), scratch_iterator(std::move(r.scratch_iterator)), arena(r.arena) {}
-	WriteMap& operator=(WriteMap&& r) BOOST_NOEXCEPT { writeMapEmpty = r.writeMapEmpty; writes = std::move(r.writes); ver = r.ver; scratch_iterator = std::move(r.scratch_iterator); arena = r.arena; return *this; }
+	WriteMap(WriteMap&& r) BOOST_NOEXCEPT : writeMapEmpty(r.writeMapEmpty), writes(std::move(r.writes)), ver(r.ver), pendingWrites(std::move(r.pendingWrites)), pendingSorted(r.pendingSorted), approxEntries(r.approxEntries), scratch_iterator(std::move(r.scratch_iterator)), arena(r.arena) {}
+	WriteMap& operator=(WriteMap&& r) BOOST_NOEXCEPT { writeMapEmpty = r.writeMapEmpty; writes = std::move(r.writes); ver = r.ver; pendingWrites = std::move(r.pendingWrites); pendingSorted = r.pendingSorted; approxEntries = r.approxEntries; scratch_iterator = std::move(r.scratch_iterator); arena = r.arena; return *this; }
 
 	//a write with addConflict false on top of an existing write with a conflict range will not remove the conflict
 	void mutate( KeyRef key, MutationRef::Type operation, ValueRef param, bool addConflict ) {
 		writeMapEmpty = false;
-		auto& it = scratch_iterator;
-		it.reset(writes, ver);
-		it.skip( key );
-		
-		bool is_cleared = it.entry().following_keys_cleared;
-		bool following_conflict = it.entry().following_keys_conflict;
-		bool is_conflict = addConflict || it.is_conflict_range();
-		bool following_unreadable = it.entry().following_keys_unreadable;
-		bool is_unreadable = it.is_unreadable() || operation == MutationRef::SetVersionstampedValue ||  operation == MutationRef::SetVersionstampedKey;
-		bool is_dependent = operation != MutationRef::SetValue && operation != MutationRef::SetVersionstampedValue && operation != MutationRef::SetVersionstampedKey;
-
-		if (it.entry().key != key) {
-			if( it.is_cleared_range() && is_dependent ) {
-				it.tree.clear();
-				OperationStack op( RYWMutation( Optional<StringRef>(), MutationRef::SetValue ) );
-				coalesceOver(op, RYWMutation(param, operation), *arena);
-				PTreeImpl::insert( writes, ver, WriteMapEntry( key, std::move(op), true, following_conflict, is_conflict, following_unreadable, is_unreadable ) );
-			} else {
-				it.tree.clear();
-				PTreeImpl::insert( writes, ver, WriteMapEntry( key, OperationStack( RYWMutation( param, operation ) ), is_cleared, following_conflict, is_conflict, following_unreadable, is_unreadable ) );
-			}
-		} else {
-			if( !it.is_unreadable() && operation == MutationRef::SetValue ) {
-				it.tree.clear();
-				PTreeImpl::remove( writes, ver, key );
-				PTreeImpl::insert( writes, ver, WriteMapEntry( key, OperationStack( RYWMutation( param, operation ) ), is_cleared, following_conflict, is_conflict, following_unreadable, is_unreadable ) );
-			} else {
-				WriteMapEntry e( it.entry() );
-				e.is_conflict = is_conflict;
-				e.is_unreadable = is_unreadable;
-				if (e.stack.size() == 0 && it.is_cleared_range() && is_dependent)  {
-					e.stack.push(RYWMutation(Optional<StringRef>(), MutationRef::SetValue));
-					coalesceOver(e.stack, RYWMutation(param, operation), *arena);
-				} else if( !is_unreadable && e.stack.size() > 0 )
-					coalesceOver( e.stack, RYWMutation( param, operation ), *arena );
-				else
-					e.stack.push( RYWMutation( param, operation ) );
-
-				it.tree.clear();
-				PTreeImpl::remove( writes, ver, e.key ); // FIXME: Make PTreeImpl::insert do this automatically (see also VersionedMap.h FIXME)
-				PTreeImpl::insert( writes, ver, std::move(e) );
-			}
+		if( operation == MutationRef::SetValue ) {
+			// Blind sets are buffered and merged into the tree the next time it is read or otherwise modified
+			if( pendingWrites.size() && key < pendingWrites.back().key )
+				pendingSorted = false;
+			pendingWrites.push_back( PendingWrite( key, param, addConflict ) );
+			return;
 		}
+		flushPendingWrites();
+		applyMutation( key, operation, param, addConflict );
 	}
 
 	void clear( KeyRangeRef keys, bool addConflict ) {
 		writeMapEmpty = false;
+		flushPendingWrites();
+		approxEntries += 2;
 		if( !addConflict ) {
 			clearNoConflict( keys );
 			return;
@@ -216,6 +184,8 @@ public:
 	}
 
 	void addUnmodifiedAndUnreadableRange( KeyRangeRef keys ) {
+		flushPendingWrites();
+		approxEntries += 2;
 		auto& it = scratch_iterator;
 		it.reset(writes, ver);
 		it.skip( keys.begin );
@@ -247,6 +217,8 @@ public:
 
 	void addConflictRange( KeyRangeRef keys ) {
 		writeMapEmpty = false;
+		flushPendingWrites();
+		approxEntries += 2;
 		auto& it = scratch_iterator;
 		it.reset(writes, ver);
 		it.skip( keys.begin );
@@ -301,7 +273,7 @@ public:
 		// Modified keys may be dependent (need to be collapsed with a snapshot value) or independent (value is known regardless of the snapshot value)
 		// Every key will belong to exactly one segment.  The first segment begins at "" and the last segment ends at \xff\xff.
 
-		explicit iterator( WriteMap* map ) : tree(map->writes), at( map->ver ), offset(false) { ++map->ver; }
+		explicit iterator( WriteMap* map ) : tree(map->flushedWrites()), at( map->ver ), offset(false) { ++map->ver; }
 			// Creates an iterator which is conceptually before the beginning of map (you may essentially only call skip() or ++ on it)
 			// This iterator also represents a snapshot (will be unaffected by future writes)
 
@@ -533,12 +505,146 @@ public:
 
 private:
 	friend class ReadYourWritesTransaction;
+
+	struct PendingWrite {
+		KeyRef key;
+		ValueRef value;
+		bool addConflict;
+
+		PendingWrite( KeyRef const& key, ValueRef const& value, bool addConflict ) : key(key), value(value), addConflict(addConflict) {}
+	};
+
+	// A run of buffered sets is merged into the tree with a single in-order pass and rebuilt in linear time when it is
+	// at least this long and at least a quarter of the size of the tree; shorter runs are inserted one at a time.
+	enum { BULK_MERGE_MIN_WRITES = 64 };
+
 	Arena* arena;
 	bool writeMapEmpty;
 	Tree writes;
 	Version ver;  // an internal version number for the tree - no connection to database versions!  Currently this is incremented after reads, so that consecutive writes have the same version and those separated by reads have different versions.
+	std::vector<PendingWrite> pendingWrites;  // Sets not yet in writes, in the order they were made
+	bool pendingSorted;  // pendingWrites is already sorted by key
+	size_t approxEntries;  // An upper bound on the number of entries in writes
 	iterator scratch_iterator;   // Avoid unnecessary memory allocation in write operations
 
+	Tree const& flushedWrites() {
+		flushPendingWrites();
+		return writes;
+	}
+
+	void flushPendingWrites() {
+		if( pendingWrites.empty() )
+			return;
+
+		if( !pendingSorted )
+			std::stable_sort( pendingWrites.begin(), pendingWrites.end(), []( PendingWrite const& a, PendingWrite const& b ) { return a.key < b.key; } );
+
+		if( pendingWrites.size() >= BULK_MERGE_MIN_WRITES && pendingWrites.size() * 4 >= approxEntries ) {
+			mergePendingWrites();
+		} else {
+			for( auto const& w : pendingWrites )
+				applyMutation( w.key, MutationRef::SetValue, w.value, w.addConflict );
+		}
+
+		pendingWrites.clear();
+		pendingSorted = true;
+	}
+
+	// Walks the tree in order, applying the (sorted) pending sets with the same rules as applyMutation(), and replaces
+	// the tree with one built from the result.  Iterators created before this keep reading the old nodes, which are
+	// never modified.
+	void mergePendingWrites() {
+		std::vector<WriteMapEntry> merged;
+		merged.reserve( approxEntries + pendingWrites.size() );
+
+		std::vector<PTreeT const*> finger;
+		PTreeImpl::first( writes, ver, finger );
+		auto w = pendingWrites.begin();
+		while( finger.size() ) {
+			WriteMapEntry const& e = finger.back()->data;
+			for(; w != pendingWrites.end() && w->key < e.key; ++w )
+				mergeSet( merged, *w );
+			merged.push_back( e );
+			PTreeImpl::next( ver, finger );
+		}
+		for(; w != pendingWrites.end(); ++w )
+			mergeSet( merged, *w );
+
+		scratch_iterator.tree.clear();
+		writes = PTreeImpl::buildSorted( merged, ver );
+		approxEntries = merged.size();
+	}
+
+	// Applies a set to the last entry of a sorted list of entries, which must be the entry at or before its key
+	static void mergeSet( std::vector<WriteMapEntry>& entries, PendingWrite const& w ) {
+		WriteMapEntry& e = entries.back();
+		bool atKey = e.key == w.key;
+		bool is_conflict = w.addConflict || ( atKey && e.stack.size() ? e.is_conflict : e.following_keys_conflict );
+		bool is_unreadable = atKey && e.stack.size() ? e.is_unreadable : e.following_keys_unreadable;
+
+		if( atKey && is_unreadable ) {
+			e.is_conflict = is_conflict;
+			e.is_unreadable = true;
+			e.stack.push( RYWMutation( w.value, MutationRef::SetValue ) );
+			return;
+		}
+
+		WriteMapEntry n( w.key, OperationStack( RYWMutation( w.value, MutationRef::SetValue ) ), e.following_keys_cleared, e.following_keys_conflict, is_conflict, e.following_keys_unreadable, is_unreadable );
+		if( atKey )
+			e = std::move(n);
+		else
+			entries.push_back( std::move(n) );
+	}
+
+	void applyMutation( KeyRef key, MutationRef::Type operation, ValueRef param, bool addConflict ) {
+		approxEntries++;
+		auto& it = scratch_iterator;
+
+		it.reset(writes, ver);
+		it.skip( key );
+		
+		bool is_cleared = it.entry().following_keys_cleared;
+		bool following_conflict = it.entry().following_keys_conflict;
+		bool is_conflict = addConflict || it.is_conflict_range();
+		bool following_unreadable = it.entry().following_keys_unreadable;
+		bool is_unreadable = it.is_unreadable() || operation == MutationRef::SetVersionstampedValue ||  operation == MutationRef::SetVersionstampedKey;
+		bool is_dependent = operation != MutationRef::SetValue && operation != MutationRef::SetVersionstampedValue && operation != MutationRef::SetVersionstampedKey;
+
+		if (it.entry().key != key) {
+			if( it.is_cleared_range() && is_dependent ) {
+				it.tree.clear();
+				OperationStack op( RYWMutation( Optional<StringRef>(), MutationRef::SetValue ) );
+				coalesceOver(op, RYWMutation(param, operation), *arena);
+				PTreeImpl::insert( writes, ver, WriteMapEntry( key, std::move(op), true, following_conflict, is_conflict, following_unreadable, is_unreadable ) );
+			} else {
+				it.tree.clear();
+				PTreeImpl::insert( writes, ver, WriteMapEntry( key, OperationStack( RYWMutation( param, operation ) ), is_cleared, following_conflict, is_conflict, following_unreadable, is_unreadable ) );
+			}
+		} else {
+			if( !it.is_unreadable() && operation == MutationRef::SetValue ) {
+				it.tree.clear();
+				PTreeImpl::remove( writes, ver, key );
+				PTreeImpl::insert( writes, ver, WriteMapEntry( key, OperationStack( RYWMutation( param, operation ) ), is_cleared, following_conflict, is_conflict, following_unreadable, is_unreadable ) );
+			} else {
+				WriteMapEntry e( it.entry() );
+				e.is_conflict = is_conflict;
+				e.is_unreadable = is_unreadable;
+				if (e.stack.size() == 0 && it.is_cleared_range() && is_dependent)  {
+					e.stack.push(RYWMutation(Optional<StringRef>(), MutationRef::SetValue));
+					coalesceOver(e.stack, RYWMutation(param, operation), *arena);
+				} else if( !is_unreadable && e.stack.size() > 0 )
+					coalesceOver( e.stack, RYWMutation( param, operation ), *arena );
+				else
+					e.stack.push( RYWMutation( param, operation ) );
+
+				it.tree.clear();
+				PTreeImpl::remove( writes, ver, e.key ); // FIXME: Make PTreeImpl::insert do this automatically (see also VersionedMap.h FIXME)
+				PTreeImpl::insert( writes, ver, std::move(e) );
+			}
+		}
+	}
+
+
 	void dump() {
 		iterator it( this );
 		it.skip(allKeys.begin);
@@ -130,26 +130,37 @@ public:
 		ASSERT(wpos == length);
 		localCache.clear();
 
-		// If the cache is too large then go through the cache in block number order and remove any entries whose future
-		// has a reference count of 1, stopping once the cache is no longer too big.  There is no point in removing
-		// an entry from the cache if it has a reference count of > 1 because it will continue to exist and use memory
-		// anyway so it should be left in the cache so that other readers may benefit from it.
+		// If the cache is too large then remove entries whose future has a reference count of 1, stopping once the cache
+		// is no longer too big.  There is no point in removing an entry from the cache if it has a reference count of > 1
+		// because it will continue to exist and use memory anyway so it should be left in the cache so that other readers
+		// may benefit from it.
+		//
+		// Readers of backup files are sequential, so blocks before this read have most likely been consumed already and
+		// are evicted first, oldest first.  Only after that are blocks removed starting from the end furthest ahead of
+		// this read, so that read ahead blocks which are still in flight are not thrown away just before they are needed.
 
 		//printf("cache block limit: %d   Cache contents:\n", f->m_cache_block_limit);
 		//for(auto &m : f->m_blocks) printf("\tblock %d refcount %d\n", m.first, m.second.getFutureReferenceCount());
 
 		if(f->m_blocks.size() > f->m_cache_block_limit) {
 			auto i = f->m_blocks.begin();
-			while(i != f->m_blocks.end()) {
+			while(i != f->m_blocks.end() && i->first < firstBlockNum && f->m_blocks.size() > f->m_cache_block_limit) {
 				if(i->second.getFutureReferenceCount() == 1) {
 					//printf("evicting block %d\n", i->first);
 					i = f->m_blocks.erase(i);
-					if(f->m_blocks.size() <= f->m_cache_block_limit)
-						break;
 				}
 				else
 					++i;
 			}
+
+			auto r = f->m_blocks.end();
+			while(r != f->m_blocks.begin() && f->m_blocks.size() > f->m_cache_block_limit) {
+				--r;
+				if(r->second.getFutureReferenceCount() == 1) {
+					//printf("evicting block %d\n", r->first);
+					r = f->m_blocks.erase(r);
+				}
+			}
 		}
 
 		return wpos;
@@ -194,7 +205,8 @@ public:
 
 	AsyncFileReadAheadCache(Reference<IAsyncFile> f, int blockSize, int readAheadBlocks, int maxConcurrentReads, int cacheSizeBlocks)
 		: m_f(f), m_block_size(blockSize), m_read_ahead_blocks(readAheadBlocks), m_max_concurrent_reads(maxConcurrentReads),
-		  m_cache_block_limit(std::max<int>(1, cacheSizeBlocks)) {
+		  // The cache must be able to hold a read's blocks plus its read ahead blocks or read ahead would be wasted
+		  m_cache_block_limit(std::max<int>(readAheadBlocks + 1, cacheSizeBlocks)) {
 	}
 
 };
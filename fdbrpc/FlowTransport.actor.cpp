@@ -24,6 +24,9 @@
 #if VALGRIND
 #include <memcheck.h>
 #endif
+#ifdef __linux__
+#include <cxxabi.h>
+#endif
 
 #include "flow/crc32c.h"
 #include "fdbrpc/fdbrpc.h"
@@ -41,6 +44,24 @@
 
 static NetworkAddressList g_currentDeliveryPeerAddress = NetworkAddressList();
 
+LatencyHistogram* g_receivingRequestLatency = nullptr;
+
+LatencyHistogram& requestLatencyHistogram(std::type_info const& requestType) {
+	std::string name = requestType.name();
+#ifdef __linux__
+	char* demangled = abi::__cxa_demangle(requestType.name(), NULL, NULL, NULL);
+	if (demangled) {
+		name = demangled;
+		free(demangled);
+	}
+#endif
+	// Histogram names are used as trace event detail names, so template arguments and namespaces can't be kept as is
+	for (char& c : name) {
+		if (!isalnum(c)) c = '_';
+	}
+	return LatencyHistogram::named(name);
+}
+
 const UID WLTOKEN_ENDPOINT_NOT_FOUND(-1, 0);
 const UID WLTOKEN_PING_PACKET(-1, 1);
 const UID TOKEN_IGNORE_PACKET(0, 2);
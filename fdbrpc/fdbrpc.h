@@ -163,7 +163,7 @@ void load(Ar& ar, ReplyPromise<T>& value) {
 	ar >> token;
 	Endpoint endpoint = FlowTransport::transport().loadedEndpoint(token);
 	value = ReplyPromise<T>(endpoint);
-	networkSender(value.getFuture(), endpoint);
+	networkSender(value.getFuture(), endpoint, g_receivingRequestLatency);
 }
 
 template <class T>
@@ -175,7 +175,7 @@ struct serializable_traits<ReplyPromise<T>> : std::true_type {
 			serializer(ar, token);
 			auto endpoint = FlowTransport::transport().loadedEndpoint(token);
 			p = ReplyPromise<T>(endpoint);
-			networkSender(p.getFuture(), endpoint);
+			networkSender(p.getFuture(), endpoint, g_receivingRequestLatency);
 		} else {
 			const auto& ep = p.getEndpoint().token;
 			serializer(ar, ep);
@@ -224,9 +224,12 @@ struct NetNotifiedQueue : NotifiedQueue<T>, FlowReceiver, FastAllocated<NetNotif
 
 	virtual void destroy() { delete this; }
 	virtual void receive(ArenaObjectReader& reader) {
+		static LatencyHistogram& latency = requestLatencyHistogram(typeid(T));
 		this->addPromiseRef();
 		T message;
+		g_receivingRequestLatency = &latency;
 		reader.deserialize(message);
+		g_receivingRequestLatency = nullptr;
 		this->send(std::move(message));
 		this->delPromiseRef();
 	}
@@ -28,16 +28,27 @@
 
 #include "fdbrpc/FlowTransport.h"
 #include "flow/flow.h"
+#include "flow/Histogram.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
+// The request currently being deserialized by NetNotifiedQueue::receive(), so that the ReplyPromises in it can record
+// the time from receipt of the request to the reply being sent
+extern LatencyHistogram* g_receivingRequestLatency;
+
+// Returns the process wide receipt-to-reply latency histogram for requests of the given type
+LatencyHistogram& requestLatencyHistogram(std::type_info const& requestType);
+
 ACTOR template <class T>
-void networkSender(Future<T> input, Endpoint endpoint) {
+void networkSender(Future<T> input, Endpoint endpoint, LatencyHistogram* latency) {
+	state double receivedAt = latency ? g_network->timer() : 0;
 	try {
 		T value = wait(input);
+		if (latency) latency->addMeasurement(g_network->timer() - receivedAt);
 		FlowTransport::transport().sendUnreliable(SerializeSource<ErrorOr<EnsureTable<T>>>(value), endpoint, false);
 	} catch (Error& err) {
 		// if (err.code() == error_code_broken_promise) return;
 		ASSERT(err.code() != error_code_actor_cancelled);
+		if (latency) latency->addMeasurement(g_network->timer() - receivedAt);
 		FlowTransport::transport().sendUnreliable(SerializeSource<ErrorOr<EnsureTable<T>>>(err), endpoint, false);
 	}
 }
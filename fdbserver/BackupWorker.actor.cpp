@@ -157,6 +157,32 @@ struct BackupData {
 		logSystem.get()->pop(savedVersion, popTag);
 	}
 
+	// Splits messages [0, numMsg) into at most BACKUP_WORKER_PARALLEL_FILES runs of about the same size, and of at
+	// least BACKUP_WORKER_MIN_FILE_BYTES, without splitting a version across runs. Returns where each run begins.
+	std::vector<int> partitionMessages(int numMsg) const {
+		int64_t totalBytes = 0;
+		for (int i = 0; i < numMsg; i++) {
+			totalBytes += messages[i].message.size();
+		}
+		// A minimum file size of 0 or less places no limit on how small the runs get
+		const int64_t minFileBytes = std::max<int64_t>(1, SERVER_KNOBS->BACKUP_WORKER_MIN_FILE_BYTES);
+		const int parts = std::max<int64_t>(
+		    1, std::min<int64_t>(SERVER_KNOBS->BACKUP_WORKER_PARALLEL_FILES, totalBytes / minFileBytes));
+		const int64_t targetBytes = totalBytes / parts;
+
+		std::vector<int> begins(1, 0);
+		int64_t bytes = 0;
+		for (int i = 0; i < numMsg; i++) {
+			if (bytes >= targetBytes && begins.size() < parts &&
+			    messages[i].getVersion() != messages[i - 1].getVersion()) {
+				begins.push_back(i);
+				bytes = 0;
+			}
+			bytes += messages[i].message.size();
+		}
+		return begins;
+	}
+
 	void eraseMessagesAfterEndVersion() {
 		ASSERT(endVersion.present());
 		const Version ver = endVersion.get();
@@ -379,50 +405,23 @@ ACTOR Future<Void> addMutation(Reference<IBackupFile> logFile, VersionedMessage
 	return Void();
 }
 
-// Saves messages in the range of [0, numMsg) to a file and then remove these
-// messages. The file format is a sequence of (Version, sub#, msgSize, message).
-// Note only ready backups are saved.
-ACTOR Future<Void> saveMutationsToFile(BackupData* self, Version popVersion, int numMsg) {
+// Saves messages in the range of [begin, end) to one file per backup, covering
+// versions [beginVersions[i], endVersion) for the i-th backup.
+ACTOR Future<Void> saveMutationPartition(BackupData* self, KeyRangeMap<std::set<int>>* keyRangeMap,
+                                         std::vector<Reference<IBackupContainer>> containers,
+                                         std::vector<Version> beginVersions, Version endVersion, int begin,
+                                         int end) {
 	state int blockSize = SERVER_KNOBS->BACKUP_FILE_BLOCK_BYTES;
 	state std::vector<Future<Reference<IBackupFile>>> logFileFutures;
 	state std::vector<Reference<IBackupFile>> logFiles;
 	state std::vector<int64_t> blockEnds;
-	state std::set<UID> activeUids; // active Backups' UIDs
-	state KeyRangeMap<std::set<int>> keyRangeMap; // range to index in logFileFutures, logFiles, & blockEnds
 	state std::vector<Standalone<StringRef>> mutations;
 	state int idx;
 
-	for (auto it = self->backups.begin(); it != self->backups.end();) {
-		if (!it->second.isRunning()) {
-			if (it->second.stopped) {
-				TraceEvent("BackupWorkerRemoveStoppedContainer", self->myId).detail("BackupId", it->first);
-				it = self->backups.erase(it);
-			} else {
-				it++;
-			}
-			continue;
-		}
-		if (!it->second.container.get().present()) {
-			TraceEvent("BackupWorkerNoContainer", self->myId).detail("BackupId", it->first);
-			it = self->backups.erase(it);
-			continue;
-		}
-		const int index = logFileFutures.size();
-		activeUids.insert(it->first);
-		self->insertRanges(keyRangeMap, it->second.ranges.get(), index);
-		if (it->second.lastSavedVersion == invalidVersion) {
-			it->second.lastSavedVersion = self->messages[0].getVersion();
-		}
-		logFileFutures.push_back(it->second.container.get().get()->writeTaggedLogFile(
-		    it->second.lastSavedVersion, popVersion + 1, blockSize, self->tag.id));
-		it++;
+	for (int i = 0; i < containers.size(); i++) {
+		logFileFutures.push_back(
+		    containers[i]->writeTaggedLogFile(beginVersions[i], endVersion, blockSize, self->tag.id));
 	}
-	if (activeUids.empty()) {
-		// stop early if there is no active backups
-		TraceEvent("BackupWorkerSkip", self->myId).detail("Count", numMsg);
-		return Void();
-	}
-	keyRangeMap.coalesce(allKeys);
 	wait(waitForAll(logFileFutures));
 
 	std::transform(logFileFutures.begin(), logFileFutures.end(), std::back_inserter(logFiles),
@@ -435,14 +434,14 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self, Version popVersion, int
 	}
 
 	blockEnds = std::vector<int64_t>(logFiles.size(), 0);
-	for (idx = 0; idx < numMsg; idx++) {
+	for (idx = begin; idx < end; idx++) {
 		const auto& message = self->messages[idx];
 		MutationRef m;
 		if (!message.isBackupMessage(&m)) continue;
 
 		std::vector<Future<Void>> adds;
 		if (m.type != MutationRef::Type::ClearRange) {
-			for (int index : keyRangeMap[m.param1]) {
+			for (int index : (*keyRangeMap)[m.param1]) {
 				adds.push_back(addMutation(logFiles[index], message, message.message, &blockEnds[index], blockSize));
 			}
 		} else {
@@ -450,7 +449,7 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self, Version popVersion, int
 			KeyRangeRef intersectionRange;
 
 			// Find intersection ranges and create mutations for sub-ranges
-			for (auto range : keyRangeMap.intersectingRanges(mutationRange)) {
+			for (auto range : keyRangeMap->intersectingRanges(mutationRange)) {
 				const auto& subrange = range.range();
 				intersectionRange = mutationRange & subrange;
 				MutationRef subm(MutationRef::Type::ClearRange, intersectionRange.begin, intersectionRange.end);
@@ -479,6 +478,73 @@ ACTOR Future<Void> saveMutationsToFile(BackupData* self, Version popVersion, int
 		    .detail("TagId", self->tag.id)
 		    .detail("File", file->getFileName());
 	}
+	return Void();
+}
+
+// Saves messages in the range of [0, numMsg) to files and then remove these
+// messages. The file format is a sequence of (Version, sub#, msgSize, message).
+// Note only ready backups are saved. Large batches are split by version into
+// several files per backup, which are written and uploaded concurrently. Each
+// file covers a contiguous version range, so the files of a tag still chain
+// from one to the next as restore expects.
+ACTOR Future<Void> saveMutationsToFile(BackupData* self, Version popVersion, int numMsg) {
+	state std::vector<Reference<IBackupContainer>> containers;
+	state std::vector<Version> beginVersions; // per backup, in the same order as containers
+	state std::set<UID> activeUids; // active Backups' UIDs
+	state KeyRangeMap<std::set<int>> keyRangeMap; // range to index in containers & beginVersions
+	state std::vector<int> partitions;
+	state std::vector<Future<Void>> saves;
+
+	for (auto it = self->backups.begin(); it != self->backups.end();) {
+		if (!it->second.isRunning()) {
+			if (it->second.stopped) {
+				TraceEvent("BackupWorkerRemoveStoppedContainer", self->myId).detail("BackupId", it->first);
+				it = self->backups.erase(it);
+			} else {
+				it++;
+			}
+			continue;
+		}
+		if (!it->second.container.get().present()) {
+			TraceEvent("BackupWorkerNoContainer", self->myId).detail("BackupId", it->first);
+			it = self->backups.erase(it);
+			continue;
+		}
+		const int index = containers.size();
+		activeUids.insert(it->first);
+		self->insertRanges(keyRangeMap, it->second.ranges.get(), index);
+		if (it->second.lastSavedVersion == invalidVersion) {
+			it->second.lastSavedVersion = self->messages[0].getVersion();
+		}
+		containers.push_back(it->second.container.get().get());
+		beginVersions.push_back(it->second.lastSavedVersion);
+		it++;
+	}
+	if (activeUids.empty()) {
+		// stop early if there is no active backups
+		TraceEvent("BackupWorkerSkip", self->myId).detail("Count", numMsg);
+		return Void();
+	}
+	keyRangeMap.coalesce(allKeys);
+
+	partitions = self->partitionMessages(numMsg);
+	for (int i = 0; i < partitions.size(); i++) {
+		const bool last = i + 1 == partitions.size();
+		const int end = last ? numMsg : partitions[i + 1];
+		const Version endVersion = last ? popVersion + 1 : self->messages[end].getVersion();
+		std::vector<Version> begins = beginVersions;
+		if (i > 0) {
+			std::fill(begins.begin(), begins.end(), self->messages[partitions[i]].getVersion());
+		}
+		saves.push_back(saveMutationPartition(self, &keyRangeMap, containers, begins, endVersion, partitions[i], end));
+	}
+	TraceEvent("BackupWorkerSaveMutations", self->myId)
+	    .detail("Count", numMsg)
+	    .detail("Files", partitions.size())
+	    .detail("Backups", containers.size())
+	    .detail("PopVersion", popVersion);
+	wait(waitForAll(saves));
+
 	for (const UID uid : activeUids) {
 		self->backups[uid].lastSavedVersion = popVersion + 1;
 	}
@@ -19,6 +19,7 @@
  */
 
 #include <algorithm>
+#include <deque>
 #include <iterator>
 #include <map>
 #include <set>
@@ -116,6 +117,13 @@ public:
 		bool cachePopulated;
 		std::map<NetworkAddress, std::pair<double, OpenDatabaseRequest>> clientStatus;
 
+		// The encoded fields of the most recently sent ServerDBInfos, oldest first, and the replies already built for
+		// the current one, keyed by the ServerDBInfo they update from
+		std::deque<std::pair<UID, std::vector<Standalone<StringRef>>>> serverInfoHistory;
+		std::map<UID, CachedSerialization<ServerDBInfoUpdate>> serverInfoUpdates;
+		// The full reply for serverInfoMasterOnly, sent to every worker that is not yet required during a recovery
+		Optional<std::pair<UID, CachedSerialization<ServerDBInfoUpdate>>> serverInfoMasterOnlyUpdate;
+
 		DBInfo() : masterRegistrationCount(0), recoveryStalled(false), forceRecovery(false), unfinishedRecoveries(0), logGenerations(0), cachePopulated(false),
 			clientInfo( new AsyncVar<ClientDBInfo>( ClientDBInfo() ) ),
 			serverInfo( new AsyncVar<CachedSerialization<ServerDBInfo>>( CachedSerialization<ServerDBInfo>() ) ),
@@ -178,6 +186,51 @@ public:
 			serverInfo->set( newInfoCache );
 		}
 
+		// Returns the reply to a worker which knows the ServerDBInfo with the given id.  Replies are shared by all
+		// workers with the same knownID, so each is only serialized once.
+		CachedSerialization<ServerDBInfoUpdate> getServerInfoUpdate(UID knownID) {
+			ServerDBInfo const& info = serverInfo->get().read();
+			if(serverInfoHistory.empty() || serverInfoHistory.back().first != info.id) {
+				serverInfoHistory.emplace_back(info.id, info.encodeFields());
+				while(serverInfoHistory.size() > std::max(1, SERVER_KNOBS->SERVER_DBINFO_HISTORY)) {
+					serverInfoHistory.pop_front();
+				}
+				serverInfoUpdates.clear();
+			}
+
+			auto cached = serverInfoUpdates.find(knownID);
+			if(cached != serverInfoUpdates.end()) {
+				return cached->second;
+			}
+
+			auto const& current = serverInfoHistory.back().second;
+			auto base = std::find_if(serverInfoHistory.begin(), serverInfoHistory.end(), [knownID](auto const& h) { return h.first == knownID; });
+			ServerDBInfoUpdate update;
+			if(knownID.isValid() && base != serverInfoHistory.end()) {
+				update.id = info.id;
+				update.baseID = knownID;
+				for(int i = 0; i < ServerDBInfo::FIELD_COUNT; i++) {
+					if(base->second[i] != current[i]) {
+						update.changedFields.push_back(i);
+						update.fieldBytes.push_back(current[i]);
+					}
+				}
+			} else {
+				update = ServerDBInfoUpdate(info);
+				knownID = UID();  // Everyone who gets the full ServerDBInfo can share it
+			}
+			return serverInfoUpdates[knownID] = CachedSerialization<ServerDBInfoUpdate>(update);
+		}
+
+		// Returns the reply to a worker which is only to know serverInfoMasterOnly, serialized once per its id
+		CachedSerialization<ServerDBInfoUpdate> getServerInfoMasterOnlyUpdate() {
+			ServerDBInfo const& info = serverInfoMasterOnly.read();
+			if(!serverInfoMasterOnlyUpdate.present() || serverInfoMasterOnlyUpdate.get().first != info.id) {
+				serverInfoMasterOnlyUpdate = std::make_pair(info.id, CachedSerialization<ServerDBInfoUpdate>(ServerDBInfoUpdate(info)));
+			}
+			return serverInfoMasterOnlyUpdate.get().second;
+		}
+
 		void clearStorageCache(uint16_t id) {
 			CachedSerialization<ServerDBInfo> newInfoCache = serverInfo->get();
 			auto& newInfo = newInfoCache.mutate();
@@ -1492,7 +1545,7 @@ ACTOR Future<Void> clusterWatchDatabase( ClusterControllerData* cluster, Cluster
 ACTOR Future<Void> clusterGetServerInfo(ClusterControllerData::DBInfo* db, UID knownServerInfoID,
                                         Standalone<VectorRef<StringRef>> issues,
                                         std::vector<NetworkAddress> incompatiblePeers,
-                                        ReplyPromise<CachedSerialization<ServerDBInfo>> reply) {
+                                        ReplyPromise<CachedSerialization<ServerDBInfoUpdate>> reply) {
 	state Optional<UID> issueID;
 	state bool useMasterOnly = false;
 	setIssues(db->workersWithIssues, reply.getEndpoint().getPrimaryAddress(), issues, issueID);
@@ -1513,7 +1566,11 @@ ACTOR Future<Void> clusterGetServerInfo(ClusterControllerData::DBInfo* db, UID k
 
 	removeIssues(db->workersWithIssues, reply.getEndpoint().getPrimaryAddress(), issueID);
 
-	reply.send( useMasterOnly ? db->serverInfoMasterOnly : db->serverInfo->get() );
+	if(useMasterOnly) {
+		reply.send( db->getServerInfoMasterOnlyUpdate() );
+	} else {
+		reply.send( db->getServerInfoUpdate(knownServerInfoID) );
+	}
 	return Void();
 }
 
@@ -2387,11 +2444,19 @@ ACTOR Future<Void> statusServer(FutureStream< StatusRequest> requests,
 	// Place to accumulate a batch of requests to respond to
 	state std::vector<StatusRequest> requests_batch;
 
+	// The last status generated, for requests arriving within STATUS_REPLY_CACHE_TTL of it
+	state Optional<StatusReply> cachedReply;
+	state Reference<StatusEventCache> eventCache(new StatusEventCache);
+
 	loop {
 		try {
 			// Wait til first request is ready
 			StatusRequest req = waitNext(requests);
 			++self->statusRequests;
+			if(cachedReply.present() && now() - last_request_time < SERVER_KNOBS->STATUS_REPLY_CACHE_TTL) {
+				req.reply.send(cachedReply.get());
+				continue;
+			}
 			requests_batch.push_back(req);
 
 			// Earliest time at which we may begin a new request
@@ -2432,13 +2497,14 @@ ACTOR Future<Void> statusServer(FutureStream< StatusRequest> requests,
 				}
 			}
 
-			state ErrorOr<StatusReply> result = wait(errorOr(clusterGetStatus(self->db.serverInfo, self->cx, workers, self->db.workersWithIssues, &self->db.clientStatus, coordinators, incompatibleConnections, self->datacenterVersionDifference)));
+			state ErrorOr<StatusReply> result = wait(errorOr(clusterGetStatus(self->db.serverInfo, self->cx, workers, self->db.workersWithIssues, &self->db.clientStatus, coordinators, incompatibleConnections, self->datacenterVersionDifference, eventCache)));
 
 			if (result.isError() && result.getError().code() == error_code_actor_cancelled)
 				throw result.getError();
 
 			// Update last_request_time now because GetStatus is finished and the delay is to be measured between requests
 			last_request_time = now();
+			cachedReply = result.present() ? result.get() : Optional<StatusReply>();
 
 			while (!requests_batch.empty())
 			{
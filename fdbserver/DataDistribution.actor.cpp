@@ -20,6 +20,7 @@
 
 #include <set>
 #include <sstream>
+#include <unordered_map>
 #include "fdbclient/SystemData.h"
 #include "fdbclient/DatabaseContext.h"
 #include "fdbclient/ManagementAPI.actor.h"
@@ -570,6 +571,71 @@ Future<Void> storageServerTracker(
 
 Future<Void> teamTracker(struct DDTeamCollection* const& self, Reference<TCTeamInfo> const& team, bool const& badTeam, bool const& redundantTeam);
 
+// Groups servers (or machines) by the number of teams they are on, so that a pass that builds many teams can
+// repeatedly pick a random least used one without scanning every server for every team it adds.  Every added item
+// counts towards anyBelowTarget(), but only eligible items can be picked.
+template <class T>
+class TeamCountIndex {
+public:
+	explicit TeamCountIndex(int target) : target(target), belowTarget(0) {}
+
+	void add(Reference<T> const& item, int teamCount, bool eligible) {
+		Entry& e = entries[item.getPtr()];
+		e.teamCount = teamCount;
+		e.position = -1;
+		if (teamCount < target) ++belowTarget;
+		if (eligible) insert(item, e);
+	}
+
+	// Records that item is now on teamCount teams; items which were never added are ignored
+	void update(Reference<T> const& item, int teamCount) {
+		auto it = entries.find(item.getPtr());
+		if (it == entries.end() || it->second.teamCount == teamCount) return;
+
+		Entry& e = it->second;
+		belowTarget += (teamCount < target) - (e.teamCount < target);
+		bool eligible = e.position >= 0;
+		if (eligible) erase(e);
+		e.teamCount = teamCount;
+		if (eligible) insert(item, e);
+	}
+
+	bool anyBelowTarget() const { return belowTarget > 0; }
+	bool empty() const { return buckets.empty(); }
+
+	// The eligible items that are on the fewest teams; must not be called when empty()
+	std::vector<Reference<T>> const& leastUsed() const { return buckets.begin()->second; }
+
+private:
+	struct Entry {
+		int teamCount;
+		int position; // Index in buckets[teamCount], or -1 if the item is not eligible
+	};
+
+	void insert(Reference<T> const& item, Entry& e) {
+		auto& bucket = buckets[e.teamCount];
+		e.position = bucket.size();
+		bucket.push_back(item);
+	}
+
+	void erase(Entry& e) {
+		auto b = buckets.find(e.teamCount);
+		auto& bucket = b->second;
+		if (e.position != bucket.size() - 1) {
+			bucket[e.position] = bucket.back();
+			entries[bucket[e.position].getPtr()].position = e.position;
+		}
+		bucket.pop_back();
+		if (bucket.empty()) buckets.erase(b);
+		e.position = -1;
+	}
+
+	int target;
+	int belowTarget; // Number of items on fewer than target teams
+	std::unordered_map<T*, Entry> entries;
+	std::map<int, std::vector<Reference<T>>> buckets;
+};
+
 struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 	// clang-format off
 	enum { REQUESTING_WORKER = 0, GETTING_WORKER = 1, GETTING_STORAGE = 2 };
@@ -1477,35 +1543,32 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 		// Step 1: Create machineLocalityMap which will be used in building machine team
 		rebuildMachineLocalityMap();
 
-		// Add a team in each iteration
-		while (addedMachineTeams < machineTeamsToBuild || notEnoughMachineTeamsForAMachine()) {
-			// Step 2: Get least used machines from which we choose machines as a machine team
-			std::vector<Reference<TCMachineInfo>> leastUsedMachines; // A less used machine has less number of teams
-			int minTeamCount = std::numeric_limits<int>::max();
-			for (auto& machine : machine_info) {
-				// Skip invalid machine whose representative server is not in server_info
-				ASSERT_WE_THINK(server_info.find(machine.second->serversOnMachine[0]->id) != server_info.end());
-				// Skip unhealthy machines
-				if (!isMachineHealthy(machine.second)) continue;
-				// Skip machine with incomplete locality
-				if (!isValidLocality(configuration.storagePolicy,
-				                     machine.second->serversOnMachine[0]->lastKnownInterface.locality)) {
-					continue;
-				}
+		// Step 2: Index the healthy machines by their number of machine teams. Machines are only picked as the least
+		// used machine of a new team if their locality is complete. The index is kept up to date as teams are added
+		// below, which is the only thing that changes while this function runs.
+		TeamCountIndex<TCMachineInfo> machineTeamCounts(getTargetMachineTeamNumPerMachine());
+		for (auto& machine : machine_info) {
+			// Skip invalid machine whose representative server is not in server_info
+			ASSERT_WE_THINK(server_info.find(machine.second->serversOnMachine[0]->id) != server_info.end());
+			// Skip unhealthy machines
+			if (!isMachineHealthy(machine.second)) continue;
 
-				// Invariant: We only create correct size machine teams.
-				// When configuration (e.g., team size) is changed, the DDTeamCollection will be destroyed and rebuilt
-				// so that the invariant will not be violated.
-				int teamCount = machine.second->machineTeams.size();
+			// Invariant: We only create correct size machine teams.
+			// When configuration (e.g., team size) is changed, the DDTeamCollection will be destroyed and rebuilt
+			// so that the invariant will not be violated.
+			machineTeamCounts.add(machine.second, machine.second->machineTeams.size(),
+			                      isValidLocality(configuration.storagePolicy,
+			                                      machine.second->serversOnMachine[0]->lastKnownInterface.locality));
+		}
 
-				if (teamCount < minTeamCount) {
-					leastUsedMachines.clear();
-					minTeamCount = teamCount;
-				}
-				if (teamCount == minTeamCount) {
-					leastUsedMachines.push_back(machine.second);
-				}
+		// Add a team in each iteration
+		while (addedMachineTeams < machineTeamsToBuild || machineTeamCounts.anyBelowTarget()) {
+			// when there is no least used machine, we will never find a team, so we can simply return.
+			if (machineTeamCounts.empty()) {
+				return addedMachineTeams;
 			}
+			// A less used machine has less number of teams
+			std::vector<Reference<TCMachineInfo>> const& leastUsedMachines = machineTeamCounts.leastUsed();
 
 			std::vector<UID*> team;
 			std::vector<LocalityEntry> forcedAttributes;
@@ -1518,21 +1581,16 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 				// Step 3: Create a representative process for each machine.
 				// Construct forcedAttribute from leastUsedMachines.
 				// We will use forcedAttribute to call existing function to form a team
-				if (leastUsedMachines.size()) {
-					forcedAttributes.clear();
-					// Randomly choose 1 least used machine
-					Reference<TCMachineInfo> tcMachineInfo = deterministicRandom()->randomChoice(leastUsedMachines);
-					ASSERT(!tcMachineInfo->serversOnMachine.empty());
-					LocalityEntry process = tcMachineInfo->localityEntry;
-					forcedAttributes.push_back(process);
-					TraceEvent("ChosenMachine")
-					    .detail("MachineInfo", tcMachineInfo->machineID)
-					    .detail("LeaseUsedMachinesSize", leastUsedMachines.size())
-					    .detail("ForcedAttributesSize", forcedAttributes.size());
-				} else {
-					// when leastUsedMachine is empty, we will never find a team later, so we can simply return.
-					return addedMachineTeams;
-				}
+				forcedAttributes.clear();
+				// Randomly choose 1 least used machine
+				Reference<TCMachineInfo> tcMachineInfo = deterministicRandom()->randomChoice(leastUsedMachines);
+				ASSERT(!tcMachineInfo->serversOnMachine.empty());
+				LocalityEntry process = tcMachineInfo->localityEntry;
+				forcedAttributes.push_back(process);
+				TraceEvent("ChosenMachine")
+				    .detail("MachineInfo", tcMachineInfo->machineID)
+				    .detail("LeaseUsedMachinesSize", leastUsedMachines.size())
+				    .detail("ForcedAttributesSize", forcedAttributes.size());
 
 				// Choose a team that balances the # of teams per server among the teams
 				// that have the least-utilized server
@@ -1596,6 +1654,9 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 
 				addMachineTeam(machines);
 				addedMachineTeams++;
+				for (auto& machine : machines) {
+					machineTeamCounts.update(machine, machine->machineTeams.size());
+				}
 			} else {
 				traceAllInfo(true);
 				TraceEvent(SevWarn, "DataDistributionBuildTeams", distributorId)
@@ -1654,33 +1715,29 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 		return false;
 	}
 
-	// Return the healthy server with the least number of correct-size server teams
-	Reference<TCServerInfo> findOneLeastUsedServer() {
-		vector<Reference<TCServerInfo>> leastUsedServers;
-		int minTeams = std::numeric_limits<int>::max();
+	// Index the healthy servers by their number of correct-size server teams. Only servers with valid locality can be
+	// picked by findOneLeastUsedServer().
+	TeamCountIndex<TCServerInfo> indexServerTeamCounts() {
+		TeamCountIndex<TCServerInfo> index(getTargetTeamNumPerServer());
 		for (auto& server : server_info) {
 			// Only pick healthy server, which is not failed or excluded.
 			if (server_status.get(server.first).isUnhealthy()) continue;
-			if (!isValidLocality(configuration.storagePolicy, server.second->lastKnownInterface.locality)) continue;
-
-			int numTeams = server.second->teams.size();
-			if (numTeams < minTeams) {
-				minTeams = numTeams;
-				leastUsedServers.clear();
-			}
-			if (minTeams == numTeams) {
-				leastUsedServers.push_back(server.second);
-			}
+			index.add(server.second, server.second->teams.size(),
+			          isValidLocality(configuration.storagePolicy, server.second->lastKnownInterface.locality));
 		}
+		return index;
+	}
 
-		if (leastUsedServers.empty()) {
+	// Return the healthy server with the least number of correct-size server teams
+	Reference<TCServerInfo> findOneLeastUsedServer(TeamCountIndex<TCServerInfo> const& serverTeamCounts) {
+		if (serverTeamCounts.empty()) {
 			// If we cannot find a healthy server with valid locality
 			TraceEvent("NoHealthyAndValidLocalityServers")
 				.detail("Servers", server_info.size())
 				.detail("UnhealthyServers", unhealthyServers);
 			return Reference<TCServerInfo>();
 		} else {
-			return deterministicRandom()->randomChoice(leastUsedServers);
+			return deterministicRandom()->randomChoice(serverTeamCounts.leastUsed());
 		}
 	}
 
@@ -1886,15 +1943,18 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 		return healthyTeamCount;
 	}
 
+	int getTargetMachineTeamNumPerMachine() {
+		// If we want to remove the machine team with most machine teams, we use the same logic as
+		// notEnoughTeamsForAServer
+		return SERVER_KNOBS->TR_FLAG_REMOVE_MT_WITH_MOST_TEAMS
+		           ? (SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER * (configuration.storageTeamSize + 1)) / 2
+		           : SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER;
+	}
+
 	// Each machine is expected to have targetMachineTeamNumPerMachine
 	// Return true if there exists a machine that does not have enough teams.
 	bool notEnoughMachineTeamsForAMachine() {
-		// If we want to remove the machine team with most machine teams, we use the same logic as
-		// notEnoughTeamsForAServer
-		int targetMachineTeamNumPerMachine =
-		    SERVER_KNOBS->TR_FLAG_REMOVE_MT_WITH_MOST_TEAMS
-		        ? (SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER * (configuration.storageTeamSize + 1)) / 2
-		        : SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER;
+		int targetMachineTeamNumPerMachine = getTargetMachineTeamNumPerMachine();
 		for (auto& m : machine_info) {
 			// If SERVER_KNOBS->TR_FLAG_REMOVE_MT_WITH_MOST_TEAMS is false,
 			// The desired machine team number is not the same with the desired server team number
@@ -1908,9 +1968,7 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 		return false;
 	}
 
-	// Each server is expected to have targetTeamNumPerServer teams.
-	// Return true if there exists a server that does not have enough teams.
-	bool notEnoughTeamsForAServer() {
+	int getTargetTeamNumPerServer() {
 		// We build more teams than we finally want so that we can use serverTeamRemover() actor to remove the teams
 		// whose member belong to too many teams. This allows us to get a more balanced number of teams per server.
 		// We want to ensure every server has targetTeamNumPerServer teams.
@@ -1920,6 +1978,13 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 		// (#servers * DESIRED_TEAMS_PER_SERVER * storageTeamSize) / #servers.
 		int targetTeamNumPerServer = (SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER * (configuration.storageTeamSize + 1)) / 2;
 		ASSERT(targetTeamNumPerServer > 0);
+		return targetTeamNumPerServer;
+	}
+
+	// Each server is expected to have targetTeamNumPerServer teams.
+	// Return true if there exists a server that does not have enough teams.
+	bool notEnoughTeamsForAServer() {
+		int targetTeamNumPerServer = getTargetTeamNumPerServer();
 		for (auto& s : server_info) {
 			if (s.second->teams.size() < targetTeamNumPerServer && !server_status.get(s.first).isUnhealthy()) {
 				return true;
@@ -1964,7 +2029,10 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 			addedMachineTeams = addBestMachineTeams(machineTeamsToBuild);
 		}
 
-		while (addedTeams < teamsToBuild || notEnoughTeamsForAServer()) {
+		// Server health does not change while this function runs, so the index only needs to be told about the teams
+		// added below
+		TeamCountIndex<TCServerInfo> serverTeamCounts = indexServerTeamCounts();
+		while (addedTeams < teamsToBuild || serverTeamCounts.anyBelowTarget()) {
 			// Step 1: Create 1 best machine team
 			std::vector<UID> bestServerTeam;
 			int bestScore = std::numeric_limits<int>::max();
@@ -1972,7 +2040,7 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 			bool earlyQuitBuild = false;
 			for (int i = 0; i < maxAttempts && i < 100; ++i) {
 				// Step 2: Choose 1 least used server and then choose 1 least used machine team from the server
-				Reference<TCServerInfo> chosenServer = findOneLeastUsedServer();
+				Reference<TCServerInfo> chosenServer = findOneLeastUsedServer(serverTeamCounts);
 				if (!chosenServer.isValid()) {
 					TraceEvent(SevWarn, "NoValidServer").detail("Primary", primary);
 					earlyQuitBuild = true;
@@ -2053,6 +2121,10 @@ struct DDTeamCollection : ReferenceCounted<DDTeamCollection> {
 			// Step 4: Add the server team
 			addTeam(bestServerTeam.begin(), bestServerTeam.end(), false);
 			addedTeams++;
+			for (auto& serverID : bestServerTeam) {
+				Reference<TCServerInfo> const& server = server_info[serverID];
+				serverTeamCounts.update(server, server->teams.size());
+			}
 		}
 
 		healthyMachineTeamCount = getHealthyMachineTeamCount();
@@ -5022,3 +5094,37 @@ TEST_CASE("/DataDistribution/AddTeamsBestOf/NotEnoughServers") {
 
 	return Void();
 }
+
+// Builds teams for a cluster with thousands of storage servers, which is what a data distributor does after it starts.
+TEST_CASE("/DataDistribution/AddTeamsBestOf/LargeCluster") {
+	// In simulation every added team traces the whole collection, which makes this far too slow
+	if (g_network->isSimulated()) return Void();
+
+	wait(Future<Void>(Void()));
+
+	state int teamSize = 3;
+	state int processSize = 5000;
+	state int desiredTeams = SERVER_KNOBS->DESIRED_TEAMS_PER_SERVER * processSize;
+	state int maxTeams = SERVER_KNOBS->MAX_TEAMS_PER_SERVER * processSize;
+
+	Reference<IReplicationPolicy> policy = Reference<IReplicationPolicy>(
+	    new PolicyAcross(teamSize, "zoneid", Reference<IReplicationPolicy>(new PolicyOne())));
+	state DDTeamCollection* collection = testMachineTeamCollection(teamSize, policy, processSize);
+
+	state double start = timer();
+	state int result = collection->addTeamsBestOf(desiredTeams, desiredTeams, maxTeams);
+	state double elapsed = timer() - start;
+
+	printf("Built %d server teams and %lu machine teams for %d servers on %lu machines in %fs\n", result,
+	       collection->machineTeams.size(), processSize, collection->machine_info.size(), elapsed);
+
+	ASSERT(result >= desiredTeams);
+	ASSERT(collection->sanityCheckTeams() == true);
+	for (auto process = collection->server_info.begin(); process != collection->server_info.end(); process++) {
+		ASSERT(process->second->teams.size() >= collection->getTargetTeamNumPerServer());
+	}
+
+	delete (collection);
+
+	return Void();
+}
@@ -343,6 +343,59 @@ void complete( RelocateData const& relocation, std::map<UID, Busyness> & busymap
 		busymap[ relocation.src[i] ].removeWork( relocation.priority, relocation.workFactor );
 }
 
+// Estimates the cost of copying a shard, in bytes.  The copy reads from the source servers while they keep serving the
+// shard's reads, so a read hot shard costs more than its size alone.
+int64_t getRelocationCost( StorageMetrics const& metrics ) {
+	double fetchSeconds = metrics.bytes / SERVER_KNOBS->DD_RELOCATION_FETCH_BYTES_PER_SECOND;
+	return metrics.bytes + int64_t( metrics.bytesReadPerKSecond / 1000.0 * fetchSeconds );
+}
+
+// Data movement's bandwidth control: tracks the estimated cost of the fetches in flight on each source and destination
+// server.  Every relocation is charged, but only rebalancing waits for room, since it can always be done later.
+struct FetchCostLedger : ReferenceCounted<FetchCostLedger> {
+	std::map<UID, int64_t> inFlight; // UID is serverID
+	int64_t totalInFlight;
+
+	FetchCostLedger() : totalInFlight(0) {}
+
+	// A fetch may read from any of the source servers, so each of them is charged its share of the cost.  A server
+	// with nothing in flight can always start a fetch, so that shards costing more than the limit still move.
+	bool canStart( std::vector<UID> const& src, std::vector<UID> const& dest, int64_t cost ) const {
+		return fits( src, sourceShare( src, cost ) ) && fits( dest, cost );
+	}
+	void start( std::vector<UID> const& src, std::vector<UID> const& dest, int64_t cost ) {
+		charge( src, sourceShare( src, cost ) );
+		charge( dest, cost );
+	}
+	void finish( std::vector<UID> const& src, std::vector<UID> const& dest, int64_t cost ) {
+		charge( src, -sourceShare( src, cost ) );
+		charge( dest, -cost );
+	}
+
+private:
+	static int64_t sourceShare( std::vector<UID> const& src, int64_t cost ) {
+		return cost / std::max<int>( 1, src.size() );
+	}
+	bool fits( std::vector<UID> const& servers, int64_t cost ) const {
+		for( auto& id : servers ) {
+			auto it = inFlight.find( id );
+			if( it != inFlight.end() && it->second + cost > SERVER_KNOBS->DD_MAX_RELOCATION_COST_PER_SERVER )
+				return false;
+		}
+		return true;
+	}
+	void charge( std::vector<UID> const& servers, int64_t cost ) {
+		for( auto& id : servers ) {
+			auto it = inFlight.insert( std::make_pair( id, int64_t(0) ) ).first;
+			it->second += cost;
+			totalInFlight += cost;
+			ASSERT( it->second >= 0 );
+			if( it->second == 0 )
+				inFlight.erase( it );
+		}
+	}
+};
+
 Future<Void> dataDistributionRelocator( struct DDQueueData* const& self, RelocateData const& rd );
 
 struct DDQueueData {
@@ -363,6 +416,7 @@ struct DDQueueData {
 	int teamSize;
 
 	std::map<UID, Busyness> busymap; // UID is serverID
+	Reference<FetchCostLedger> fetchCosts;
 
 	KeyRangeMap< RelocateData > queueMap;
 	std::set<RelocateData, std::greater<RelocateData>> fetchingSourcesQueue;
@@ -423,7 +477,8 @@ struct DDQueueData {
 			shardsAffectedByTeamFailure( sABTF ), getAverageShardBytes( getAverageShardBytes ), distributorId( mid ), lock( lock ),
 			cx( cx ), teamSize( teamSize ), output( output ), input( input ), getShardMetrics( getShardMetrics ), startMoveKeysParallelismLock( SERVER_KNOBS->DD_MOVE_KEYS_PARALLELISM ),
 			finishMoveKeysParallelismLock( SERVER_KNOBS->DD_MOVE_KEYS_PARALLELISM ), lastLimited(lastLimited),
-			suppressIntervals(0), lastInterval(0), unhealthyRelocations(0), rawProcessingUnhealthy( new AsyncVar<bool>(false) ) {}
+			suppressIntervals(0), lastInterval(0), unhealthyRelocations(0), rawProcessingUnhealthy( new AsyncVar<bool>(false) ),
+			fetchCosts( new FetchCostLedger() ) {}
 
 	void validate() {
 		if( EXPENSIVE_VALIDATION ) {
@@ -904,6 +959,10 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 	state std::vector<std::pair<Reference<IDataDistributionTeam>,bool>> bestTeams;
 	state double startTime = now();
 	state std::vector<UID> destIds;
+	state Reference<FetchCostLedger> fetchCosts( self->fetchCosts );
+	state int64_t fetchCost = 0; // Charged to rd.src and fetchCostDestIds while the keys are being moved
+	state std::vector<UID> fetchCostDestIds;
+	state double costWaitStart = 0;
 
 	try {
 		if(now() - self->lastInterval < 1.0) {
@@ -921,6 +980,7 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 		}
 
 		state StorageMetrics metrics = wait( brokenPromiseToNever( self->getShardMetrics.getReply( GetMetricsRequest( rd.keys ) ) ) );
+		state int64_t cost = getRelocationCost(metrics);
 
 		ASSERT( rd.src.size() );
 		loop {
@@ -979,6 +1039,29 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 				wait( delay( SERVER_KNOBS->BEST_TEAM_STUCK_DELAY, TaskPriority::DataDistributionLaunch ) );
 			}
 
+			// Every server of the chosen teams fetches, whether from the source or from the one server chosen in its team
+			fetchCostDestIds.clear();
+			for(auto& team : bestTeams) {
+				auto& serverIds = team.first->getServerIDs();
+				fetchCostDestIds.insert(fetchCostDestIds.end(), serverIds.begin(), serverIds.end());
+			}
+			if (rd.priority == SERVER_KNOBS->PRIORITY_REBALANCE_UNDERUTILIZED_TEAM ||
+			    rd.priority == SERVER_KNOBS->PRIORITY_REBALANCE_OVERUTILIZED_TEAM) {
+				if (!fetchCosts->canStart(rd.src, fetchCostDestIds, cost)) {
+					// Teams are chosen again after waiting, since by then others may be less busy than these
+					if (!costWaitStart) costWaitStart = now();
+					wait( delay( SERVER_KNOBS->DD_RELOCATION_COST_RECHECK_DELAY, TaskPriority::DataDistributionLaunch ) );
+					continue;
+				}
+				if (costWaitStart) {
+					TraceEvent(relocateShardInterval.severity, "RelocateShardWaitedForFetchCost", distributorId)
+						.detail("PairId", relocateShardInterval.pairID)
+						.detail("Cost", cost)
+						.detail("Duration", now() - costWaitStart);
+					costWaitStart = 0;
+				}
+			}
+
 			destIds.clear();
 			state std::vector<UID> healthyIds;
 			state std::vector<UID> extraIds;
@@ -1023,6 +1106,9 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 				    .detail("DestTeamSize", totalIds);
 			}
 
+			fetchCosts->start(rd.src, fetchCostDestIds, cost);
+			fetchCost = cost;
+
 			self->shardsAffectedByTeamFailure->moveShard(rd.keys, destinationTeams);
 
 			//FIXME: do not add data in flight to servers that were already in the src.
@@ -1077,6 +1163,9 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 
 			//TraceEvent("RelocateShardFinished", distributorId).detail("RelocateId", relocateShardInterval.pairID);
 
+			fetchCosts->finish(rd.src, fetchCostDestIds, fetchCost);
+			fetchCost = 0;
+
 			if( error.code() != error_code_move_to_removed_server ) {
 				if( !error.code() ) {
 					try {
@@ -1117,6 +1206,9 @@ ACTOR Future<Void> dataDistributionRelocator( DDQueueData *self, RelocateData rd
 			}
 		}
 	} catch (Error& e) {
+		if (fetchCost) {
+			fetchCosts->finish(rd.src, fetchCostDestIds, fetchCost);
+		}
 		TraceEvent(relocateShardInterval.end(), distributorId).error(e, true).detail("Duration", now() - startTime);
 		if(now() - startTime > 600) {
 			TraceEvent(SevWarnAlways, "RelocateShardTooLong").error(e, true).detail("Duration", now() - startTime).detail("Dest", describe(destIds)).detail("Src", describe(rd.src));
@@ -1499,6 +1591,7 @@ ACTOR Future<Void> dataDistributionQueue(
 						.detail( "UnhealthyRelocations", self.unhealthyRelocations )
 						.detail( "HighestPriority", highestPriorityRelocation )
 						.detail( "BytesWritten", self.bytesWritten )
+						.detail( "FetchCostInFlight", self.fetchCosts->totalInFlight )
 						.detail( "PriorityRecoverMove", self.priority_relocations[SERVER_KNOBS->PRIORITY_RECOVER_MOVE] )
 						.detail( "PriorityRebalanceUnderutilizedTeam", self.priority_relocations[SERVER_KNOBS->PRIORITY_REBALANCE_UNDERUTILIZED_TEAM] )
 						.detail( "PriorityRebalanceOverutilizedTeam", self.priority_relocations[SERVER_KNOBS->PRIORITY_REBALANCE_OVERUTILIZED_TEAM] )
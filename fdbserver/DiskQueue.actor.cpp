@@ -187,14 +187,33 @@ public:
 		firstPages[1] = (Page*)((uintptr_t)firstPages[0] + 4096);
 		memset(firstPages[1], 0xFF, sizeof(Page));
 		stallCount.init(LiteralStringRef("RawDiskQueue.StallCount"));
+		groupedCommitCount.init(LiteralStringRef("RawDiskQueue.GroupedCommitCount"));
 	}
 
 	Future<Void> pushAndCommit( StringRef pageData, StringBuffer* pageMem, uint64_t poppedPages ) {
-		return pushAndCommit( this, pageData, pageMem, poppedPages );
+		ASSERT( pageData.begin() == pageMem->ref().begin() && pageData.size() == pageMem->size() );
+		// If the last commit is still waiting for its turn to write, merge this one into it so that both
+		// are written with a single write and made durable with a single sync.
+		if (pendingGroup && pendingGroup->pageMem->size() + pageData.size() <= SERVER_KNOBS->DISK_QUEUE_GROUP_COMMIT_MAX_BYTES) {
+			pendingGroup->pageMem->alignReserve( sizeof(Page), pendingGroup->pageMem->size() + pageData.size() );
+			pendingGroup->pageMem->append( pageData );
+			pendingGroup->poppedPages += poppedPages;
+			pendingGroup->commits++;
+			groupedCommitCount++;
+			delete pageMem;
+			return pendingGroup->committed.getFuture();
+		}
+
+		Reference<CommitGroup> group( new CommitGroup(pageMem, poppedPages) );
+		if (SERVER_KNOBS->DISK_QUEUE_GROUP_COMMIT_MAX_BYTES > 0)
+			pendingGroup = group;
+		return pushAndCommit( this, group );
 	}
 
 	void stall() {
 		stallCount++;
+		// The next commit must not be written with (or before the end of) any earlier one, so close the open group
+		pendingGroup.clear();
 		readyToPush = lastCommit;
 	}
 
@@ -245,6 +264,17 @@ public:
 		}
 	};
 	File files[2];  // After readFirstAndLastPages(), files[0] is logically before files[1] (pushes are always into files[1])
+
+	// One or more commits which are written and synced together
+	struct CommitGroup : ReferenceCounted<CommitGroup> {
+		StringBuffer* pageMem;  // Owned until the data has been written
+		uint64_t poppedPages;
+		int commits;
+		Promise<Void> committed;
+
+		CommitGroup( StringBuffer* pageMem, uint64_t poppedPages ) : pageMem(pageMem), poppedPages(poppedPages), commits(1) {}
+	};
+	Reference<CommitGroup> pendingGroup;  // The newest commit group, while it has not yet started writing and can accept more commits
 	Standalone<VectorRef<Page*>> firstPages;
 
 	std::string basename;
@@ -272,6 +302,7 @@ public:
 	int64_t fileShrinkBytes;
 
 	Int64MetricHandle stallCount;
+	Int64MetricHandle groupedCommitCount;
 
 	Future<Void> truncateFile(int file, int64_t pos) { return truncateFile(this, file, pos); }
 
@@ -389,9 +420,9 @@ public:
 		return waitForAll(waitfor);
 	}
 
-	// Write the given data (pageData) to the queue files of self, sync data to disk, and delete the memory (pageMem) that hold the pageData
-	ACTOR static UNCANCELLABLE Future<Void> pushAndCommit(RawDiskQueue_TwoFiles* self, StringRef pageData, StringBuffer* pageMem, uint64_t poppedPages) {
-		state Promise<Void> pushing, committed;
+	// Write the data of the given commit group to the queue files of self, sync data to disk, and delete the memory (pageMem) that hold the data
+	ACTOR static UNCANCELLABLE Future<Void> pushAndCommit(RawDiskQueue_TwoFiles* self, Reference<CommitGroup> group) {
+		state Promise<Void> pushing;
 		state Promise<Void> errorPromise = self->error;
 		state std::string filename = self->files[0].dbgFilename;
 		state UID dbgid = self->dbgid;
@@ -402,7 +433,7 @@ public:
 			// a previous commit to finish if stall() was called
 			Future<Void> ready = self->readyToPush;
 			self->readyToPush = pushing.getFuture();
-			self->lastCommit = committed.getFuture();
+			self->lastCommit = group->committed.getFuture();
 
 			// the first commit must complete before we can pipeline other commits so that we will always have a valid page to binary search to
 			if(self->isFirstCommit) {
@@ -412,7 +443,12 @@ public:
 
 			wait( ready );
 
+			// Commits made while earlier ones were being written are in this group, which is now written as it is
+			if (self->pendingGroup == group) self->pendingGroup.clear();
+
+			state StringRef pageData = group->pageMem->ref();
 			TEST( pageData.size() > sizeof(Page) ); // push more than one page of data
+			TEST( group->commits > 1 ); // multiple commits written and synced together
 
 			Future<Void> pushed = wait( self->push( pageData, &syncFiles ) );
 			pushing.send(Void());
@@ -420,35 +456,38 @@ public:
 			TEST(2==syncFiles.size());  // push spans both files
 			wait( pushed );
 
-			delete pageMem;
-			pageMem = 0;
+			delete group->pageMem;
+			group->pageMem = 0;
 
+			// Our write overlapped the previous commit's sync, but commits complete in order, so our sync follows it
+			wait( lastCommit );
 			Future<Void> sync = syncFiles[0]->onSync();
 			for(int i=1; i<syncFiles.size(); i++) sync = sync && syncFiles[i]->onSync();
 			wait( sync );
-			wait( lastCommit );
 
 			//Calling check_yield instead of yield to avoid a destruction ordering problem in simulation
 			if(g_network->check_yield(g_network->getCurrentTask())) {
 				wait(delay(0, g_network->getCurrentTask()));
 			}
 
-			self->updatePopped( poppedPages*sizeof(Page) );
+			self->updatePopped( group->poppedPages*sizeof(Page) );
 
-			/*TraceEvent("RDQCommitEnd", self->dbgid).detail("DeltaPopped", poppedPages*sizeof(Page)).detail("PoppedCommitted", self->dbg_file0BeginSeq + self->files[0].popped + self->files[1].popped)
+			/*TraceEvent("RDQCommitEnd", self->dbgid).detail("DeltaPopped", group->poppedPages*sizeof(Page)).detail("PoppedCommitted", self->dbg_file0BeginSeq + self->files[0].popped + self->files[1].popped)
 				.detail("File0Size", self->files[0].size).detail("File1Size", self->files[1].size)
-				.detail("File0Name", self->files[0].dbgFilename).detail("SyncedFiles", syncFiles.size());*/
+				.detail("File0Name", self->files[0].dbgFilename).detail("SyncedFiles", syncFiles.size()).detail("Commits", group->commits);*/
 
-			committed.send(Void());
+			group->committed.send(Void());
 		} catch (Error& e) {
-			delete pageMem;
+			if (self->pendingGroup == group) self->pendingGroup.clear();
+			delete group->pageMem;
+			group->pageMem = 0;
 			TEST(true);  // push error
 			TEST(2==syncFiles.size());  // push spanning both files error
 			TraceEvent(SevError, "RDQPushAndCommitError", dbgid).error(e, true).detail("InitialFilename0", filename);
 
 			if (errorPromise.canBeSet()) errorPromise.sendError(e);
 			if (pushing.canBeSet()) pushing.sendError(e);
-			if (committed.canBeSet()) committed.sendError(e);
+			if (group->committed.canBeSet()) group->committed.sendError(e);
 
 			throw e;
 		}
@@ -895,6 +934,12 @@ public:
 	virtual location getNextReadLocation() { return nextReadLocation; }
 	virtual location getNextCommitLocation() { ASSERT( initialized ); return lastCommittedSeq + sizeof(Page); }
 	virtual location getNextPushLocation() { ASSERT( initialized ); return endLocation(); }
+	virtual location getReadLocationAfterPop( location popped ) {
+		// As in initializeRecovery(), reading never starts inside a page header
+		int64_t offset = popped.lo % sizeof(Page);
+		if (offset < sizeof(PageHeader)) popped.lo += sizeof(PageHeader) - offset;
+		return popped;
+	}
 
 	virtual Future<Void> getError() { return rawQueue->getError(); }
 	virtual Future<Void> onClosed() { return rawQueue->onClosed(); }
@@ -1404,6 +1449,7 @@ public:
 	virtual Future<Standalone<StringRef>> read( location start, location end, CheckHashes ch ) { return queue->read( start, end, ch ); }
 	virtual location getNextCommitLocation() { return queue->getNextCommitLocation(); }
 	virtual location getNextPushLocation() { return queue->getNextPushLocation(); }
+	virtual location getReadLocationAfterPop( location popped ) { return queue->getReadLocationAfterPop(popped); }
 
 
 	virtual location push( StringRef contents ) {
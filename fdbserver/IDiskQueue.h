@@ -71,6 +71,7 @@ public:
 	virtual location getNextReadLocation() = 0;    // Returns a location >= the location of all bytes previously returned by readNext(), and <= the location of all bytes subsequently returned
 	virtual location getNextCommitLocation() = 0;  // If commit() were to be called, all buffered writes would be written starting at `location`.
 	virtual location getNextPushLocation() = 0;  // If push() were to be called, the pushed data would be written starting at `location`.
+	virtual location getReadLocationAfterPop( location popped ) = 0;  // Where readNext() would start after recovering a queue popped up to `popped`, which may be past it if `popped` falls in the queue's own framing
 
 	virtual Future<Standalone<StringRef>> read( location start, location end, CheckHashes vc ) = 0;
 	virtual location push( StringRef contents ) = 0;  // Appends the given bytes to the byte stream.  Returns a location token representing the *end* of the contents.
@@ -90,6 +90,7 @@ extern IKeyValueStore* keyValueStoreRedwoodV1( std::string const& filename, UID
 extern IKeyValueStore* keyValueStoreMemory(std::string const& basename, UID logID, int64_t memoryLimit,
                                            std::string ext = "fdq",
                                            KeyValueStoreType storeType = KeyValueStoreType::MEMORY);
+extern IKeyValueStore* keyValueStoreBloomFilter(IKeyValueStore* store, UID logID);
 extern IKeyValueStore* keyValueStoreLogSystem( class IDiskQueue* queue, UID logID, int64_t memoryLimit, bool disableSnapshot, bool replaceContent, bool exactRecovery );
 
 inline IKeyValueStore* openKVStore( KeyValueStoreType storeType, std::string const& filename, UID logID, int64_t memoryLimit, bool checkChecksums=false, bool checkIntegrity=false ) {
@@ -110,6 +111,16 @@ inline IKeyValueStore* openKVStore( KeyValueStoreType storeType, std::string con
 	UNREACHABLE(); // FIXME: is this right?
 }
 
+// Like openKVStore(), but for the data of a storage server: if STORAGE_BLOOM_FILTER_BYTES is set, reads of missing keys
+// from the engines that keep their data on disk are mostly answered by a bloom filter
+inline IKeyValueStore* openStorageKVStore( KeyValueStoreType storeType, std::string const& filename, UID logID, int64_t memoryLimit, bool checkChecksums=false, bool checkIntegrity=false ) {
+	IKeyValueStore* store = openKVStore( storeType, filename, logID, memoryLimit, checkChecksums, checkIntegrity );
+	if( SERVER_KNOBS->STORAGE_BLOOM_FILTER_BYTES > 0 && ( storeType == KeyValueStoreType::SSD_BTREE_V1 || storeType == KeyValueStoreType::SSD_BTREE_V2 || storeType == KeyValueStoreType::SSD_REDWOOD_V1 ) ) {
+		return keyValueStoreBloomFilter( store, logID );
+	}
+	return store;
+}
+
 void GenerateIOLogChecksumFile(std::string filename);
 Future<Void> KVFileCheck(std::string const & filename, bool const &integrity);
 
@@ -0,0 +1,442 @@
+/*
+ * KeyValueStoreBloomFilter.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+
+#include "fdbclient/Notified.h"
+#include "fdbclient/SystemData.h"
+#include "fdbserver/IKeyValueStore.h"
+#include "flow/Hash3.h"
+#include "flow/Stats.h"
+#include "flow/UnitTest.h"
+#include "flow/actorcompiler.h" // has to be last include
+
+// A bloom filter over keys with a fixed number of bits, using double hashing to derive the bit positions
+struct KeyBloomFilter {
+	KeyBloomFilter(int64_t bytes, int hashes)
+	  : words(std::max<int64_t>(1, bytes / sizeof(uint64_t)), 0), hashes(hashes), bitsSet(0) {}
+
+	void add(KeyRef key) {
+		uint64_t h1, h2;
+		hash(key, h1, h2);
+		for (int i = 0; i < hashes; i++) {
+			uint64_t bit = (h1 + i * h2) % bits();
+			uint64_t mask = uint64_t(1) << (bit % 64);
+			if (!(words[bit / 64] & mask)) {
+				words[bit / 64] |= mask;
+				bitsSet++;
+			}
+		}
+	}
+
+	bool mayContain(KeyRef key) const {
+		uint64_t h1, h2;
+		hash(key, h1, h2);
+		for (int i = 0; i < hashes; i++) {
+			uint64_t bit = (h1 + i * h2) % bits();
+			if (!(words[bit / 64] & (uint64_t(1) << (bit % 64)))) return false;
+		}
+		return true;
+	}
+
+	// Forgets every key, keeping the same bits
+	void reset(int newHashes) {
+		std::fill(words.begin(), words.end(), 0);
+		hashes = newHashes;
+		bitsSet = 0;
+	}
+
+	uint64_t bits() const { return words.size() * 64; }
+	int64_t bytes() const { return words.size() * sizeof(uint64_t); }
+	int hashCount() const { return hashes; }
+	double fillRatio() const { return double(bitsSet) / bits(); }
+	// The chance that a key which was never added is reported as present
+	double estimatedFalsePositiveRate() const { return pow(fillRatio(), hashes); }
+	// Estimates how many distinct keys were added from how many bits are set
+	double estimatedKeys() const {
+		return fillRatio() < 1 ? -double(bits()) / hashes * log(1 - fillRatio()) : std::numeric_limits<double>::max();
+	}
+
+	// The number of hashes that minimizes the false positive rate for the given number of keys
+	static int optimalHashes(uint64_t bits, double keys) {
+		return std::max(1, std::min(16, int(round(bits / std::max(keys, 1.0) * log(2.0)))));
+	}
+
+private:
+	std::vector<uint64_t> words;
+	int hashes;
+	int64_t bitsSet;
+
+	static void hash(KeyRef key, uint64_t& h1, uint64_t& h2) {
+		uint32_t a = 0, b = 0;
+		hashlittle2(key.begin(), key.size(), &a, &b);
+		h1 = (uint64_t(a) << 32) | b;
+		h2 = ((h1 * 0x9e3779b97f4a7c15ULL) >> 17) | 1;
+	}
+};
+
+// KeyValueStoreBloomFilter wraps an IKeyValueStore and answers most point reads of keys that don't exist from an in
+// memory bloom filter over every key in the store, without reading any pages.
+//
+// The filter is built by scanning the store once it has been initialized, at no more than
+// STORAGE_BLOOM_FILTER_SCAN_BYTES_PER_SECOND, and every key that is set is added to it.  Clears can't be removed from a
+// bloom filter, so as keys are cleared (or the store outgrows the filter) its false positive rate rises.  Every
+// STORAGE_BLOOM_FILTER_REBUILD_DELAY the rate measured on the reads of missing keys since the last check is compared
+// with STORAGE_BLOOM_FILTER_REBUILD_FALSE_POSITIVE_RATE and with twice the rate estimated just after the last build;
+// once it is above both, the filter is emptied and built again in place.  Reads are not filtered while it is being
+// built.  Only keys in allKeys are in the filter; system keys (from \xff on, including the storage server's own
+// \xff\xff metadata) are always read from the store.
+struct KeyValueStoreBloomFilter : IKeyValueStore {
+	// Shared with the actors that outlive a close() of the wrapper, such as reads that are still outstanding
+	struct FilterState : ReferenceCounted<FilterState> {
+		std::unique_ptr<KeyBloomFilter> filter; // Null until the first build starts, and only consulted between builds
+		bool building;
+		double falsePositiveRateAfterBuild;
+
+		int64_t commitsStarted;
+		int64_t lastSetCommit; // The commit that will make the most recent set durable
+		NotifiedVersion commitsCompleted;
+
+		CounterCollection cc;
+		Counter filteredReads, falsePositives, positiveReads, builds;
+
+		explicit FilterState(UID id)
+		  : building(false), falsePositiveRateAfterBuild(0), commitsStarted(0), lastSetCommit(0), commitsCompleted(0),
+		    cc("BloomFilter", id.toString()), filteredReads("FilteredReads", cc),
+		    falsePositives("FalsePositives", cc), positiveReads("PositiveReads", cc), builds("Builds", cc) {}
+	};
+
+	IKeyValueStore* store;
+	UID id;
+	int64_t filterBytes;
+	Reference<FilterState> shared;
+	Future<Void> maintainer, logger;
+
+	KeyValueStoreBloomFilter(IKeyValueStore* store, UID id, int64_t filterBytes)
+	  : store(store), id(id), filterBytes(filterBytes), shared(new FilterState(id)) {
+		FilterState* s = shared.getPtr();
+		specialCounter(s->cc, "Bytes", [s]() { return s->filter ? s->filter->bytes() : 0; });
+		specialCounter(s->cc, "Hashes", [s]() { return s->filter ? s->filter->hashCount() : 0; });
+		specialCounter(s->cc, "FillRatio", [s]() { return s->filter ? s->filter->fillRatio() : 0; });
+		specialCounter(s->cc, "EstimatedFalsePositiveRate",
+		               [s]() { return s->filter ? s->filter->estimatedFalsePositiveRate() : 1.0; });
+		// Of the reads of missing keys that the filter was consulted for, the fraction it didn't catch
+		specialCounter(s->cc, "FalsePositiveRate", [s]() {
+			int64_t misses = s->filteredReads.getValue() + s->falsePositives.getValue();
+			return misses ? double(s->falsePositives.getValue()) / misses : 0.0;
+		});
+		specialCounter(s->cc, "Building", [s]() { return s->building ? 1 : 0; });
+		logger = traceCounters("BloomFilterMetrics", id, SERVER_KNOBS->STORAGE_LOGGING_DELAY, &s->cc,
+		                       id.toString() + "/BloomFilterMetrics");
+	}
+
+	virtual Future<Void> getError() { return store->getError(); }
+	virtual Future<Void> onClosed() { return store->onClosed(); }
+	virtual void dispose() { store->dispose(); delete this; }
+	virtual void close() { store->close(); delete this; }
+
+	virtual KeyValueStoreType getType() { return store->getType(); }
+	virtual StorageBytes getStorageBytes() { return store->getStorageBytes(); }
+	virtual void resyncLog() { store->resyncLog(); }
+	virtual void enableSnapshot() { store->enableSnapshot(); }
+
+	virtual Future<Void> init() {
+		Future<Void> initialized = store->init();
+		maintainer = maintain(this, initialized);
+		return initialized;
+	}
+
+	virtual void set(KeyValueRef keyValue, const Arena* arena = NULL) {
+		if (shared->filter) shared->filter->add(keyValue.key);
+		shared->lastSetCommit = shared->commitsStarted + 1;
+		store->set(keyValue, arena);
+	}
+	virtual void clear(KeyRangeRef range, const Arena* arena = NULL) { store->clear(range, arena); }
+	virtual Future<Void> commit(bool sequential = false) {
+		return notifyCommitted(shared, store->commit(sequential), ++shared->commitsStarted);
+	}
+
+	virtual Future<Optional<Value>> readValue(KeyRef key, Optional<UID> debugID = Optional<UID>()) {
+		if (!isFiltered(key)) return store->readValue(key, debugID);
+		if (!shared->filter->mayContain(key)) {
+			++shared->filteredReads;
+			return Optional<Value>();
+		}
+		return countFalsePositive(shared, store->readValue(key, debugID));
+	}
+	virtual Future<Optional<Value>> readValuePrefix(KeyRef key, int maxLength,
+	                                                Optional<UID> debugID = Optional<UID>()) {
+		if (!isFiltered(key)) return store->readValuePrefix(key, maxLength, debugID);
+		if (!shared->filter->mayContain(key)) {
+			++shared->filteredReads;
+			return Optional<Value>();
+		}
+		return countFalsePositive(shared, store->readValuePrefix(key, maxLength, debugID));
+	}
+	virtual Future<Standalone<RangeResultRef>> readRange(KeyRangeRef keys, int rowLimit = 1 << 30,
+	                                                     int byteLimit = 1 << 30) {
+		return store->readRange(keys, rowLimit, byteLimit);
+	}
+
+	// Builds the filter from a scan of the store, emptying and reusing the current one if there is one
+	ACTOR static Future<Void> build(KeyValueStoreBloomFilter* self) {
+		state Reference<FilterState> s = self->shared;
+		state Key begin = allKeys.begin;
+		state int64_t keys = 0;
+		state double startTime = now();
+
+		// The first build can only guess how many keys there are; later ones size the hash count from the last filter
+		if (s->filter) {
+			s->filter->reset(KeyBloomFilter::optimalHashes(s->filter->bits(), s->filter->estimatedKeys()));
+		} else {
+			s->filter.reset(new KeyBloomFilter(self->filterBytes, SERVER_KNOBS->STORAGE_BLOOM_FILTER_HASHES));
+		}
+		s->building = true;
+
+		// Keys set before the build started are only seen by the scan once they are durable
+		wait(s->commitsCompleted.whenAtLeast(s->lastSetCommit));
+
+		loop {
+			Standalone<RangeResultRef> rows = wait(
+			    self->store->readRange(KeyRangeRef(begin, allKeys.end), 1 << 30, SERVER_KNOBS->STORAGE_BLOOM_FILTER_SCAN_BYTES));
+			if (rows.empty()) break;
+			for (auto& kv : rows) s->filter->add(kv.key);
+			keys += rows.size();
+			begin = keyAfter(rows.back().key);
+			wait(delay(rows.expectedSize() / SERVER_KNOBS->STORAGE_BLOOM_FILTER_SCAN_BYTES_PER_SECOND));
+		}
+
+		s->building = false;
+		s->falsePositiveRateAfterBuild = s->filter->estimatedFalsePositiveRate();
+		++s->builds;
+		TraceEvent("BloomFilterBuilt", self->id)
+		    .detail("Keys", keys)
+		    .detail("Bytes", s->filter->bytes())
+		    .detail("Hashes", s->filter->hashCount())
+		    .detail("EstimatedFalsePositiveRate", s->falsePositiveRateAfterBuild)
+		    .detail("Duration", now() - startTime);
+		return Void();
+	}
+
+private:
+	bool isFiltered(KeyRef key) const { return shared->filter && !shared->building && key < allKeys.end; }
+
+	ACTOR static Future<Void> notifyCommitted(Reference<FilterState> shared, Future<Void> committed, int64_t commit) {
+		wait(committed);
+		if (commit > shared->commitsCompleted.get()) shared->commitsCompleted.set(commit);
+		return Void();
+	}
+
+	ACTOR static Future<Optional<Value>> countFalsePositive(Reference<FilterState> shared, Future<Optional<Value>> read) {
+		Optional<Value> v = wait(read);
+		if (v.present())
+			++shared->positiveReads;
+		else
+			++shared->falsePositives;
+		return v;
+	}
+
+	ACTOR static Future<Void> maintain(KeyValueStoreBloomFilter* self, Future<Void> initialized) {
+		state int64_t filteredReads = 0;
+		state int64_t falsePositives = 0;
+		wait(initialized);
+		try {
+			wait(build(self));
+			loop {
+				filteredReads = self->shared->filteredReads.getValue();
+				falsePositives = self->shared->falsePositives.getValue();
+				wait(delay(SERVER_KNOBS->STORAGE_BLOOM_FILTER_REBUILD_DELAY));
+
+				int64_t newFalsePositives = self->shared->falsePositives.getValue() - falsePositives;
+				int64_t misses = self->shared->filteredReads.getValue() - filteredReads + newFalsePositives;
+				if (misses < SERVER_KNOBS->STORAGE_BLOOM_FILTER_REBUILD_MIN_SAMPLES) continue;
+				double falsePositiveRate = double(newFalsePositives) / misses;
+				if (falsePositiveRate > SERVER_KNOBS->STORAGE_BLOOM_FILTER_REBUILD_FALSE_POSITIVE_RATE &&
+				    falsePositiveRate > 2 * self->shared->falsePositiveRateAfterBuild) {
+					TraceEvent("BloomFilterRebuild", self->id)
+					    .detail("FalsePositiveRate", falsePositiveRate)
+					    .detail("Misses", misses)
+					    .detail("EstimatedFalsePositiveRate", self->shared->filter->estimatedFalsePositiveRate())
+					    .detail("AfterLastBuild", self->shared->falsePositiveRateAfterBuild);
+					wait(build(self));
+				}
+			}
+		} catch (Error& e) {
+			if (e.code() == error_code_actor_cancelled) throw;
+			// Errors from the store itself are reported through getError(); reads just stop being filtered
+			TraceEvent(SevWarn, "BloomFilterBuildFailed", self->id).error(e);
+			self->shared->building = false;
+			self->shared->filter.reset();
+		}
+		return Void();
+	}
+};
+
+IKeyValueStore* keyValueStoreBloomFilter(IKeyValueStore* store, UID logID) {
+	return new KeyValueStoreBloomFilter(store, logID, SERVER_KNOBS->STORAGE_BLOOM_FILTER_BYTES);
+}
+
+// A store that keeps its data in a map, whose range reads (the filter's scans) can be held until a gate opens
+struct BloomFilterTestStore : IKeyValueStore {
+	std::map<Key, Value> data;
+	Future<Void> scanGate;
+	Promise<Void> closed;
+
+	BloomFilterTestStore() : scanGate(Void()) {}
+
+	virtual Future<Void> getError() { return Never(); }
+	virtual Future<Void> onClosed() { return closed.getFuture(); }
+	virtual void dispose() { close(); }
+	virtual void close() {
+		closed.send(Void());
+		delete this;
+	}
+
+	virtual KeyValueStoreType getType() { return KeyValueStoreType::SSD_BTREE_V2; }
+	virtual StorageBytes getStorageBytes() { return StorageBytes(0, 0, 0, 0); }
+
+	virtual void set(KeyValueRef keyValue, const Arena* arena = NULL) { data[keyValue.key] = keyValue.value; }
+	virtual void clear(KeyRangeRef range, const Arena* arena = NULL) {
+		data.erase(data.lower_bound(range.begin), data.lower_bound(range.end));
+	}
+	virtual Future<Void> commit(bool sequential = false) { return Void(); }
+
+	virtual Future<Optional<Value>> readValue(KeyRef key, Optional<UID> debugID = Optional<UID>()) {
+		auto it = data.find(key);
+		if (it == data.end()) return Optional<Value>();
+		return Optional<Value>(it->second);
+	}
+	virtual Future<Optional<Value>> readValuePrefix(KeyRef key, int maxLength,
+	                                                Optional<UID> debugID = Optional<UID>()) {
+		auto it = data.find(key);
+		if (it == data.end()) return Optional<Value>();
+		return Optional<Value>(it->second.substr(0, std::min(maxLength, it->second.size())));
+	}
+	virtual Future<Standalone<RangeResultRef>> readRange(KeyRangeRef keys, int rowLimit = 1 << 30,
+	                                                     int byteLimit = 1 << 30) {
+		return readRangeAfterGate(this, keys, rowLimit, byteLimit);
+	}
+
+	ACTOR static Future<Standalone<RangeResultRef>> readRangeAfterGate(BloomFilterTestStore* self, KeyRange keys,
+	                                                                   int rowLimit, int byteLimit) {
+		wait(self->scanGate);
+		state Standalone<RangeResultRef> result;
+		for (auto it = self->data.lower_bound(keys.begin);
+		     it != self->data.end() && it->first < keys.end && result.size() < rowLimit &&
+		     result.expectedSize() < byteLimit;
+		     ++it) {
+			result.push_back_deep(result.arena(), KeyValueRef(it->first, it->second));
+		}
+		result.more = result.size() && result.size() == rowLimit;
+		return result;
+	}
+};
+
+static Key bloomFilterTestKey(int i) {
+	return StringRef(format("key%04d", i));
+}
+
+// Reads keys [begin, end) through the store, checking that exactly those set in expected are present
+ACTOR static Future<Void> checkBloomFilterTestStore(IKeyValueStore* store, std::set<int> expected, int begin, int end) {
+	state int i = begin;
+	for (; i < end; i++) {
+		Optional<Value> value = wait(store->readValue(bloomFilterTestKey(i)));
+		ASSERT(value.present() == (expected.count(i) > 0));
+		if (value.present()) ASSERT(value.get() == bloomFilterTestKey(i));
+	}
+	return Void();
+}
+
+TEST_CASE("/fdbserver/KeyValueStoreBloomFilter/store") {
+	state BloomFilterTestStore* inner = new BloomFilterTestStore();
+	state KeyValueStoreBloomFilter* store = new KeyValueStoreBloomFilter(inner, deterministicRandom()->randomUniqueID(), 10000);
+	state std::set<int> expected;
+	state int64_t filteredReads;
+	state Promise<Void> scanGate;
+	state Future<Void> rebuilt;
+
+	for (int i = 0; i < 200; i += 2) {
+		inner->set(KeyValueRef(bloomFilterTestKey(i), bloomFilterTestKey(i)));
+		expected.insert(i);
+	}
+	wait(store->init());
+	while (!store->shared->builds.getValue()) wait(delay(0.01));
+	// Later builds are started below rather than by the false positive rate
+	store->maintainer.cancel();
+
+	// 80000 bits hold the 100 keys with almost no false positives, so most of the missing keys are filtered
+	filteredReads = store->shared->filteredReads.getValue();
+	wait(checkBloomFilterTestStore(store, expected, 0, 300));
+	ASSERT(store->shared->filteredReads.getValue() - filteredReads > 150);
+
+	for (int i = 1; i < 50; i += 2) {
+		store->set(KeyValueRef(bloomFilterTestKey(i), bloomFilterTestKey(i)));
+		expected.insert(i);
+	}
+	store->clear(KeyRangeRef(bloomFilterTestKey(0), bloomFilterTestKey(100)));
+	for (int i = 0; i < 100; i += 2) expected.erase(i);
+	wait(store->commit());
+	wait(checkBloomFilterTestStore(store, expected, 0, 300));
+
+	// While the filter is rebuilt, reads go to the store and sets still reach the filter
+	inner->scanGate = scanGate.getFuture();
+	rebuilt = KeyValueStoreBloomFilter::build(store);
+	ASSERT(store->shared->building && !rebuilt.isReady());
+	filteredReads = store->shared->filteredReads.getValue();
+	wait(checkBloomFilterTestStore(store, expected, 0, 300));
+	ASSERT(store->shared->filteredReads.getValue() == filteredReads);
+	store->set(KeyValueRef(bloomFilterTestKey(299), bloomFilterTestKey(299)));
+	expected.insert(299);
+	wait(store->commit());
+	scanGate.send(Void());
+	wait(rebuilt);
+
+	// The rebuilt filter has every key, including the one set during the build, and none of the cleared ones
+	ASSERT(!store->shared->building);
+	filteredReads = store->shared->filteredReads.getValue();
+	wait(checkBloomFilterTestStore(store, expected, 0, 300));
+	ASSERT(store->shared->filteredReads.getValue() - filteredReads > 200);
+
+	state Future<Void> closed = store->onClosed();
+	store->dispose();
+	wait(closed);
+	return Void();
+}
+
+TEST_CASE("/fdbserver/KeyValueStoreBloomFilter/filter") {
+	const int keys = 10000;
+	const int64_t bytes = keys * 10 / 8; // 10 bits per key
+	KeyBloomFilter filter(bytes, KeyBloomFilter::optimalHashes(bytes * 8, keys));
+	ASSERT(filter.hashCount() == 7);
+
+	for (int i = 0; i < keys; i++) filter.add(StringRef(format("key%d", i)));
+	for (int i = 0; i < keys; i++) ASSERT(filter.mayContain(StringRef(format("key%d", i))));
+
+	int falsePositives = 0;
+	for (int i = 0; i < keys; i++) falsePositives += filter.mayContain(StringRef(format("missing%d", i)));
+	double rate = double(falsePositives) / keys;
+	double estimate = filter.estimatedFalsePositiveRate();
+	// About 0.8% for 10 bits per key and 7 hashes
+	ASSERT(estimate > 0.005 && estimate < 0.012);
+	ASSERT(rate < 2 * estimate);
+	ASSERT(fabs(filter.estimatedKeys() - keys) < keys * 0.05);
+
+	return Void();
+}
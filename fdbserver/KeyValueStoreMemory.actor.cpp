@@ -25,24 +25,51 @@
 #include "flow/ActorCollection.h"
 #include "fdbclient/Notified.h"
 #include "fdbclient/SystemData.h"
+#include "fdbrpc/IAsyncFile.h"
+#include "flow/crc32c.h"
+#include "flow/UnitTest.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
 #define OP_DISK_OVERHEAD (sizeof(OpHeader) + 1)
 
+// A checkpoint file is a header (magic, format version, and the log location it was started at), followed by
+// [int32 keyLength][int32 valueLength][key][value] records in key order, followed by a footer whose key length is -1
+// and which holds the record count and a crc32c of everything before it.
+static const uint64_t CHECKPOINT_MAGIC = 0x314b43504d53564bULL; // "KVSMPCK1"
+static const uint32_t CHECKPOINT_FORMAT_VERSION = 1;
+static const int CHECKPOINT_HEADER_BYTES = 32;
+static const int CHECKPOINT_FOOTER_BYTES = 20;
+
 extern bool noUnseed;
 
 template <typename Container>
 class KeyValueStoreMemory : public IKeyValueStore, NonCopyable {
 public:
 	KeyValueStoreMemory(IDiskQueue* log, UID id, int64_t memoryLimit, KeyValueStoreType storeType, bool disableSnapshot,
-	                    bool replaceContent, bool exactRecovery);
+	                    bool replaceContent, bool exactRecovery,
+	                    std::vector<std::string> const& checkpointFiles = std::vector<std::string>(),
+	                    int64_t checkpointMinBytes = 0, double checkpointInterval = 0);
+
+	// Where the log replayed on top of the checkpoint recovery loaded started, if it loaded one
+	Optional<IDiskQueue::location> recoveredCheckpoint;
+	int64_t checkpointPops; // The number of times the log has been popped up to a written checkpoint
+
+	// Replaces data with the checkpoint that a log popped up to recoverFrom would be replayed on top of, as recovery
+	// does, returning false if there is none.  Only for tests, on a recovered store that is not being written.
+	Future<bool> loadCheckpointAt(IDiskQueue::location recoverFrom) {
+		data.clear();
+		dataSets.clear();
+		return recoverCheckpoint(this, recoverFrom);
+	}
 
 	// IClosable
 	virtual Future<Void> getError() { return log->getError(); }
 	virtual Future<Void> onClosed() { return log->onClosed(); }
 	virtual void dispose() {
 		recovering.cancel();
+		checkpointing.cancel();
 		log->dispose();
+		if (!checkpointFiles.empty()) deleteCheckpointFiles(checkpointFiles);
 		if (reserved_buffer != nullptr) {
 			delete[] reserved_buffer;
 			reserved_buffer = nullptr;
@@ -51,6 +78,7 @@ public:
 	}
 	virtual void close() {
 		recovering.cancel();
+		checkpointing.cancel();
 		log->close();
 		if (reserved_buffer != nullptr) {
 			delete[] reserved_buffer;
@@ -147,6 +175,7 @@ public:
 
 		if (transactionIsLarge) {
 			fullSnapshot(data);
+			if (!snapshotsInLog) checkpointStartWriteBytes = notifiedCommittedWriteBytes.get();
 			resetSnapshot = true;
 			committedWriteBytes = notifiedCommittedWriteBytes.get();
 			overheadWriteBytes = 0;
@@ -170,6 +199,17 @@ public:
 				log_op(OpCommit, StringRef(), StringRef());
 				overheadWriteBytes = log->getCommitOverhead();
 			}
+
+			// Once checkpoints have replaced in-log snapshots, they start between commits rather than at snapshot ends
+			if (!snapshotsInLog) maybeStartCheckpoint(log->getNextPushLocation());
+		}
+
+		// A written checkpoint can replace the log before it once a commit issued after it has been made durable
+		IDiskQueue::location popLocation = previousSnapshotEnd;
+		bool popsCheckpoint = checkpointEnd.present();
+		if (popsCheckpoint) {
+			if (popLocation < checkpointEnd.get()) popLocation = checkpointEnd.get();
+			checkpointEnd = Optional<IDiskQueue::location>();
 		}
 
 		auto c = log->commit();
@@ -179,7 +219,7 @@ public:
 		transactionIsLarge = false;
 		firstCommitWithSnapshot = false;
 
-		addActor.send(commitAndUpdateVersions(this, c, previousSnapshotEnd));
+		addActor.send(commitAndUpdateVersions(this, c, popLocation, ++commitCount, popsCheckpoint));
 		return c;
 	}
 
@@ -365,6 +405,23 @@ private:
 	int64_t memoryLimit; // The upper limit on the memory used by the store (excluding, possibly, some clear operations)
 	std::vector<std::pair<KeyValueMapPair, uint64_t>> dataSets;
 
+	// Checkpoints are written alternately to the two files in checkpointFiles, so the one the log has been popped past
+	// is never overwritten until the pop past its successor is durable.
+	std::vector<std::string> checkpointFiles; // Empty if this store does not checkpoint
+	Future<Void> checkpointing;
+	Optional<IDiskQueue::location> checkpointEnd; // A written checkpoint which the next commit() will pop the log up to
+	int checkpointSlot; // The file holding the most recently written (or recovered) checkpoint
+	int64_t commitCount;
+	int64_t checkpointPopCommit; // While >= 0, the log was popped past a checkpoint after this many commits were
+	                             // issued, and that pop is not durable until a later commit completes
+	double nextCheckpointTime;
+	int64_t checkpointMinBytes; // Stores holding less data than this don't write checkpoints, though they still
+	                            // recover from one they find
+	double checkpointInterval;
+	bool snapshotsInLog; // False once a checkpoint has been written, after which the log is popped up to checkpoints
+	                     // alone and the snapshot actor idles
+	int64_t checkpointStartWriteBytes; // committedWriteBytes when the last checkpoint was started
+
 	int64_t commit_queue(OpQueue& ops, bool log, bool sequential = false) {
 		int64_t total = 0, count = 0;
 		IDiskQueue::location log_location = 0;
@@ -444,10 +501,30 @@ private:
 			state OpQueue recoveryQueue;
 			state OpHeader h;
 
+			state IDiskQueue::location recoverFrom;
+			state bool loadedCheckpoint = false;
+			state bool checkpointCorrupt = false;
+			state bool uncommittedSnapshotComplete = false; // Whether the replayed log holds a complete snapshot
+			state bool snapshotComplete = false;
+
 			TraceEvent("KVSMemRecoveryStarted", self->id)
 				.detail("SnapshotEndLocation", uncommittedSnapshotEnd);
 
 			try {
+				if (!self->checkpointFiles.empty()) {
+					wait(success(self->log->initializeRecovery(0)));
+					recoverFrom = self->log->getNextReadLocation();
+					try {
+						bool loaded = wait(recoverCheckpoint(self, recoverFrom));
+						loadedCheckpoint = loaded;
+					} catch (Error& e) {
+						if (e.code() != error_code_checksum_failed) throw;
+						checkpointCorrupt = true;
+						self->data.clear();
+						self->dataSets.clear();
+					}
+				}
+
 				loop {
 					{
 						Standalone<StringRef> data = wait( self->log->readNext( sizeof(OpHeader) ) );
@@ -507,6 +584,7 @@ private:
 							if(h.op == OpSnapshotEnd) {
 								uncommittedPrevSnapshotEnd = uncommittedSnapshotEnd;
 								uncommittedSnapshotEnd = self->log->getNextReadLocation();
+								uncommittedSnapshotComplete = true;
 								recoveryQueue.clear_to_end( uncommittedNextKey, &uncommittedNextKey.arena() );
 							}
 
@@ -526,6 +604,7 @@ private:
 							self->recoveredSnapshotKey = uncommittedNextKey;
 							self->previousSnapshotEnd = uncommittedPrevSnapshotEnd;
 							self->currentSnapshotEnd = uncommittedSnapshotEnd;
+							snapshotComplete = uncommittedSnapshotComplete;
 						} else if (h.op == OpRollback) { // rollback previous transaction
 							recoveryQueue.rollback();
 							TraceEvent("KVSMemRecSnapshotRollback", self->id)
@@ -533,6 +612,7 @@ private:
 							uncommittedNextKey = self->recoveredSnapshotKey;
 							uncommittedPrevSnapshotEnd = self->previousSnapshotEnd;
 							uncommittedSnapshotEnd = self->currentSnapshotEnd;
+							uncommittedSnapshotComplete = snapshotComplete;
 						} else
 							ASSERT(false);
 					} else {
@@ -556,6 +636,16 @@ private:
 					wait( yield() );
 				}
 
+				if (!self->checkpointFiles.empty() && !loadedCheckpoint && !snapshotComplete &&
+				    self->log->getReadLocationAfterPop(0) < recoverFrom) {
+					// The log has been popped, so what was before it is in a checkpoint, but no checkpoint started
+					// where the log does and the log holds no complete snapshot to recover from without one
+					TraceEvent(SevError, "KVSMemCheckpointNeeded", self->id)
+					    .detail("RecoveredFrom", recoverFrom)
+					    .detail("CheckpointCorrupt", checkpointCorrupt);
+					throw checksum_failed();
+				}
+
 				if (zeroFillSize) {
 					if( exactRecovery ) {
 						TraceEvent(SevError, "KVSMemExpectedExact", self->id);
@@ -572,8 +662,13 @@ private:
 				self->log_op( OpRollback, StringRef(), StringRef() );  // rollback previous transaction
 
 				self->committedDataSize = self->data.sumTo(self->data.end());
+				if (loadedCheckpoint) self->recoveredCheckpoint = recoverFrom;
+				// A store that no longer checkpoints goes back to snapshotting into the log, which it must since
+				// the log after a checkpoint need not hold a snapshot
+				self->snapshotsInLog = !loadedCheckpoint || self->checkpointMinBytes <= 0;
 
 				TraceEvent("KVSMemRecovered", self->id)
+					.detail("LoadedCheckpoint", loadedCheckpoint)
 					.detail("SnapshotItems", dbgSnapshotItemCount)
 					.detail("SnapshotEnd", dbgSnapshotEndCount)
 					.detail("Mutations", dbgMutationCount)
@@ -594,6 +689,283 @@ private:
 		}
 	}
 
+	// Loads the checkpoint which starts where the log will be replayed from, returning false if there is none.  The
+	// log is only popped up to a checkpoint once it is durable, and neither file is rewritten while the log may have
+	// been popped up to it, so this is the checkpoint the log was popped up to.  If instead the log was popped up to an
+	// in-log snapshot, any older checkpoint is not loaded, since the complete snapshot that follows replaces it anyway.
+	// A checkpoint whose header can't be read might be the one the log was popped up to, so unless another one starts
+	// there it fails with checksum_failed like a checkpoint that fails to load.
+	ACTOR static Future<bool> recoverCheckpoint(KeyValueStoreMemory* self, IDiskQueue::location recoverFrom) {
+		state std::vector<Future<ErrorOr<Optional<IDiskQueue::location>>>> starts;
+		for (auto const& filename : self->checkpointFiles) {
+			starts.push_back(errorOr(readCheckpointHeader(self->id, filename)));
+		}
+		wait(waitForAll(starts));
+
+		state int slot = -1;
+		state bool badHeader = false;
+		for (int i = 0; i < starts.size(); i++) {
+			if (starts[i].get().isError()) {
+				if (starts[i].get().getError().code() != error_code_checksum_failed) throw starts[i].get().getError();
+				badHeader = true;
+			} else if (starts[i].get().get().present() &&
+			           self->log->getReadLocationAfterPop(starts[i].get().get().get()) == recoverFrom) {
+				slot = i;
+			}
+		}
+		if (slot < 0) {
+			if (badHeader) throw checksum_failed();
+			return false;
+		}
+
+		wait(loadCheckpoint(self, slot, starts[slot].get().get().get()));
+		self->checkpointSlot = slot;
+		return true;
+	}
+
+	static Optional<IDiskQueue::location> parseCheckpointHeader(StringRef header) {
+		BinaryReader rd(header, Unversioned());
+		uint64_t magic;
+		uint32_t formatVersion, reserved;
+		IDiskQueue::location start;
+		rd >> magic >> formatVersion >> reserved >> start.hi >> start.lo;
+		if (magic != CHECKPOINT_MAGIC || formatVersion != CHECKPOINT_FORMAT_VERSION) {
+			return Optional<IDiskQueue::location>();
+		}
+		return start;
+	}
+
+	// Returns the log location the checkpoint in the given file was started at, if there is a file, or fails with
+	// checksum_failed if the file doesn't start with a checkpoint header
+	ACTOR static Future<Optional<IDiskQueue::location>> readCheckpointHeader(UID id, std::string filename) {
+		try {
+			state Reference<IAsyncFile> file = wait(IAsyncFileSystem::filesystem()->open(
+			    filename, IAsyncFile::OPEN_READONLY | IAsyncFile::OPEN_UNCACHED, 0));
+			state Standalone<StringRef> header = makeString(CHECKPOINT_HEADER_BYTES);
+			int bytesRead = wait(file->read(mutateString(header), CHECKPOINT_HEADER_BYTES, 0));
+			Optional<IDiskQueue::location> start;
+			if (bytesRead == CHECKPOINT_HEADER_BYTES) start = parseCheckpointHeader(header);
+			if (!start.present()) {
+				TraceEvent(SevWarnAlways, "KVSMemCheckpointBadHeader", id).detail("Filename", filename);
+				throw checksum_failed();
+			}
+			return start;
+		} catch (Error& e) {
+			if (e.code() != error_code_file_not_found) throw;
+			return Optional<IDiskQueue::location>();
+		}
+	}
+
+	// Adds the whole records at the start of buf to data, returning the number of bytes consumed, or -1 if the
+	// checkpoint is malformed.  fromStart is true when buf begins with the header.
+	int parseCheckpoint(StringRef buf, bool fromStart, IDiskQueue::location start, uint32_t* checksum,
+	                    int64_t* records, bool* complete) {
+		const uint8_t* p = buf.begin();
+		if (fromStart) {
+			if (buf.size() < CHECKPOINT_HEADER_BYTES) return 0;
+			Optional<IDiskQueue::location> headerStart = parseCheckpointHeader(buf.substr(0, CHECKPOINT_HEADER_BYTES));
+			if (!headerStart.present() || !(headerStart.get() == start)) return -1;
+			*checksum = crc32c_append(*checksum, p, CHECKPOINT_HEADER_BYTES);
+			p += CHECKPOINT_HEADER_BYTES;
+		}
+
+		bool malformed = false;
+		while (buf.end() - p >= 2 * sizeof(int32_t)) {
+			int32_t keyLength, valueLength;
+			memcpy(&keyLength, p, sizeof(int32_t));
+			memcpy(&valueLength, p + sizeof(int32_t), sizeof(int32_t));
+			if (keyLength < 0) {
+				if (buf.end() - p < CHECKPOINT_FOOTER_BYTES) break;
+				int64_t count;
+				uint32_t footerChecksum;
+				memcpy(&count, p + 2 * sizeof(int32_t), sizeof(int64_t));
+				memcpy(&footerChecksum, p + 2 * sizeof(int32_t) + sizeof(int64_t), sizeof(uint32_t));
+				malformed = keyLength != -1 || count != *records || footerChecksum != *checksum;
+				*complete = !malformed;
+				p += CHECKPOINT_FOOTER_BYTES;
+				break;
+			}
+			if (valueLength < 0) {
+				malformed = true;
+				break;
+			}
+			int64_t recordBytes = 2 * sizeof(int32_t) + int64_t(keyLength) + valueLength;
+			if (buf.end() - p < recordBytes) break;
+
+			*checksum = crc32c_append(*checksum, p, recordBytes);
+			const uint8_t* key = p + 2 * sizeof(int32_t);
+			KeyValueMapPair pair(StringRef(key, keyLength), StringRef(key + keyLength, valueLength));
+			dataSets.push_back(std::make_pair(pair, pair.arena.getSize() + data.getElementBytes()));
+			++*records;
+			p += recordBytes;
+		}
+		data.insert(dataSets);
+		dataSets.clear();
+		return malformed ? -1 : p - buf.begin();
+	}
+
+	// Reads the checkpoint in the given slot into data, throwing checksum_failed if it is not intact
+	ACTOR static Future<Void> loadCheckpoint(KeyValueStoreMemory* self, int slot, IDiskQueue::location start) {
+		state std::string filename = self->checkpointFiles[slot];
+		state double startTime = now();
+		state Reference<IAsyncFile> file;
+		state int64_t fileSize;
+		state int64_t readOffset = 0;
+		state Standalone<StringRef> pending; // Read but not yet parsed
+		state uint32_t checksum = 0;
+		state int64_t records = 0;
+		state bool complete = false;
+
+		Reference<IAsyncFile> f = wait(
+		    IAsyncFileSystem::filesystem()->open(filename, IAsyncFile::OPEN_READONLY | IAsyncFile::OPEN_UNCACHED, 0));
+		file = f;
+		int64_t size = wait(file->size());
+		fileSize = size;
+
+		while (!complete && readOffset < fileSize) {
+			state int chunkBytes = std::min<int64_t>(SERVER_KNOBS->KVS_MEMORY_CHECKPOINT_BATCH_BYTES, fileSize - readOffset);
+			state Standalone<StringRef> buffer = makeString(pending.size() + chunkBytes);
+			memcpy(mutateString(buffer), pending.begin(), pending.size());
+			int bytesRead = wait(file->read(mutateString(buffer) + pending.size(), chunkBytes, readOffset));
+			if (bytesRead != chunkBytes) break;
+			readOffset += chunkBytes;
+
+			int parsed = self->parseCheckpoint(buffer, readOffset == buffer.size(), start, &checksum, &records, &complete);
+			if (parsed < 0) break;
+			pending = buffer.substr(parsed);
+			wait(yield());
+		}
+
+		if (!complete || readOffset != fileSize || pending.size()) {
+			TraceEvent(SevWarnAlways, "KVSMemCheckpointCorrupt", self->id)
+			    .detail("Filename", filename)
+			    .detail("Location", start)
+			    .detail("FileSize", fileSize)
+			    .detail("ReadOffset", readOffset)
+			    .detail("Records", records);
+			throw checksum_failed();
+		}
+
+		TraceEvent("KVSMemCheckpointLoaded", self->id)
+		    .detail("Filename", filename)
+		    .detail("Location", start)
+		    .detail("Bytes", fileSize)
+		    .detail("Records", records)
+		    .detail("TimeTaken", now() - startTime);
+		return Void();
+	}
+
+	// Called as each in-log snapshot ends at the given location, or once checkpoints have replaced in-log snapshots,
+	// after each commit with the location the next one will start at.  In that case a checkpoint is only started
+	// once as much has been logged since the last one as an in-log snapshot would have written.
+	void maybeStartCheckpoint(IDiskQueue::location start) {
+		if (checkpointFiles.empty() || checkpointMinBytes <= 0 || (checkpointing.isValid() && !checkpointing.isReady()) ||
+		    checkpointEnd.present() || checkpointPopCommit >= 0 || now() < nextCheckpointTime ||
+		    committedDataSize < checkpointMinBytes ||
+		    (!snapshotsInLog && committedWriteBytes - checkpointStartWriteBytes < committedDataSize)) {
+			return;
+		}
+		nextCheckpointTime = now() + checkpointInterval;
+		checkpointStartWriteBytes = committedWriteBytes;
+		checkpointing = writeCheckpoint(this, start, 1 - checkpointSlot);
+	}
+
+	// Writes the contents of data to a checkpoint file, which together with the log from start recovers the store.
+	// The checkpoint is fuzzy: each batch reads data as it is then, and replaying the log from start brings any key
+	// changed while it was being written up to date.
+	ACTOR static Future<Void> writeCheckpoint(KeyValueStoreMemory* self, IDiskQueue::location start, int slot) {
+		state std::string filename = self->checkpointFiles[slot];
+		state double startTime = now();
+		state Reference<IAsyncFile> file;
+		state Standalone<StringRef> batch;
+		state int64_t offset = 0;
+		state int64_t records = 0;
+		state uint32_t checksum = 0;
+		state Key lastKey;
+		state bool done = false;
+
+		TraceEvent("KVSMemCheckpointStarted", self->id).detail("Filename", filename).detail("Location", start);
+
+		try {
+			Reference<IAsyncFile> f = wait(IAsyncFileSystem::filesystem()->open(
+			    filename,
+			    IAsyncFile::OPEN_ATOMIC_WRITE_AND_CREATE | IAsyncFile::OPEN_CREATE | IAsyncFile::OPEN_READWRITE |
+			        IAsyncFile::OPEN_UNCACHED,
+			    0600));
+			file = f;
+			wait(file->truncate(0));
+
+			while (!done) {
+				BinaryWriter wr(Unversioned());
+				if (offset == 0) {
+					wr << CHECKPOINT_MAGIC << CHECKPOINT_FORMAT_VERSION << uint32_t(0) << start.hi << start.lo;
+				}
+
+				auto it = records ? self->data.upper_bound(lastKey) : self->data.begin();
+				StringRef key;
+				bool wroteKey = false;
+				while (it != self->data.end() && wr.getLength() < SERVER_KNOBS->KVS_MEMORY_CHECKPOINT_BATCH_BYTES) {
+					key = it.getKey(self->reserved_buffer);
+					ValueRef value = it.getValue();
+					wr << int32_t(key.size()) << int32_t(value.size());
+					wr.serializeBytes(key);
+					wr.serializeBytes(value);
+					wroteKey = true;
+					++records;
+					++it;
+				}
+				if (wroteKey) lastKey = key;
+				done = it == self->data.end();
+
+				batch = wr.toValue();
+				checksum = crc32c_append(checksum, batch.begin(), batch.size());
+				if (done) {
+					BinaryWriter footer(Unversioned());
+					footer << int32_t(-1) << int32_t(0) << records << checksum;
+					batch = batch.withSuffix(footer.toValue());
+				}
+
+				wait(file->write(batch.begin(), batch.size(), offset));
+				offset += batch.size();
+			}
+
+			// With OPEN_ATOMIC_WRITE_AND_CREATE the file only replaces the previous one in this slot once it is synced
+			wait(file->sync());
+
+			self->checkpointSlot = slot;
+			self->checkpointEnd = start;
+			self->snapshotsInLog = false;
+			TraceEvent("KVSMemCheckpointWritten", self->id)
+			    .detail("Filename", filename)
+			    .detail("Location", start)
+			    .detail("Bytes", offset)
+			    .detail("Records", records)
+			    .detail("TimeTaken", now() - startTime);
+		} catch (Error& e) {
+			if (e.code() == error_code_actor_cancelled) throw;
+			TraceEvent(SevWarnAlways, "KVSMemCheckpointFailed", self->id).error(e).detail("Filename", filename);
+			if (!self->snapshotsInLog) {
+				// The log can't be popped again without another checkpoint, so go back to in-log snapshots.  Their
+				// first one starts over, so that recovery from a later snapshot end doesn't rely on the log before it.
+				self->snapshotsInLog = true;
+				self->resetSnapshot = true;
+				self->log_op(OpSnapshotAbort, StringRef(), StringRef());
+			}
+		}
+		return Void();
+	}
+
+	ACTOR static void deleteCheckpointFiles(std::vector<std::string> filenames) {
+		state int i = 0;
+		for (; i < filenames.size(); i++) {
+			try {
+				wait(IAsyncFileSystem::filesystem()->deleteFile(filenames[i], false));
+			} catch (Error& e) {
+				TraceEvent(SevWarn, "KVSMemCheckpointDeleteFailed").error(e).detail("Filename", filenames[i]);
+			}
+		}
+	}
+
 	// Snapshots an entire data set
 	void fullSnapshot(Container& snapshotData) {
 		previousSnapshotEnd = log_op(OpSnapshotAbort, StringRef(), StringRef());
@@ -634,6 +1006,12 @@ private:
 		loop {
 			wait( self->notifiedCommittedWriteBytes.whenAtLeast( snapshotTotalWrittenBytes + 1 ) );
 
+			if (!self->snapshotsInLog) {
+				// The log is popped up to checkpoints, so nothing needs to be snapshotted into it
+				snapshotTotalWrittenBytes = self->notifiedCommittedWriteBytes.get();
+				continue;
+			}
+
 			if (self->resetSnapshot) {
 				nextKey = Key();
 				nextKeyAfter = false;
@@ -666,6 +1044,7 @@ private:
 				ASSERT(thisSnapshotEnd >= self->currentSnapshotEnd);
 				self->previousSnapshotEnd = self->currentSnapshotEnd;
 				self->currentSnapshotEnd = thisSnapshotEnd;
+				self->maybeStartCheckpoint(thisSnapshotEnd);
 
 				if (++self->snapshotCount == 2) {
 					self->replaceContent = false;
@@ -707,9 +1086,15 @@ private:
 		wait(self->commit(sequential));
 		return Void();
 	}
-	ACTOR static Future<Void> commitAndUpdateVersions( KeyValueStoreMemory* self, Future<Void> commit, IDiskQueue::location location ) {
+	ACTOR static Future<Void> commitAndUpdateVersions( KeyValueStoreMemory* self, Future<Void> commit, IDiskQueue::location location, int64_t commitNumber, bool popsCheckpoint ) {
 		wait( commit );
 		self->log->pop(location);
+		if (popsCheckpoint) {
+			self->checkpointPopCommit = self->commitCount;
+			++self->checkpointPops;
+		} else if (self->checkpointPopCommit >= 0 && commitNumber > self->checkpointPopCommit) {
+			self->checkpointPopCommit = -1;
+		}
 		return Void();
 	}
 };
@@ -717,11 +1102,15 @@ private:
 template <typename Container>
 KeyValueStoreMemory<Container>::KeyValueStoreMemory(IDiskQueue* log, UID id, int64_t memoryLimit,
                                                     KeyValueStoreType storeType, bool disableSnapshot,
-                                                    bool replaceContent, bool exactRecovery)
-  : log(log), id(id), type(storeType), previousSnapshotEnd(-1), currentSnapshotEnd(-1), resetSnapshot(false),
-    memoryLimit(memoryLimit), committedWriteBytes(0), overheadWriteBytes(0), committedDataSize(0), transactionSize(0),
+                                                    bool replaceContent, bool exactRecovery,
+                                                    std::vector<std::string> const& checkpointFiles,
+                                                    int64_t checkpointMinBytes, double checkpointInterval)
+  : checkpointPops(0), log(log), id(id), type(storeType), previousSnapshotEnd(-1), currentSnapshotEnd(-1),
+    resetSnapshot(false), memoryLimit(memoryLimit), committedWriteBytes(0), overheadWriteBytes(0), committedDataSize(0), transactionSize(0),
     transactionIsLarge(false), disableSnapshot(disableSnapshot), replaceContent(replaceContent), snapshotCount(0),
-    firstCommitWithSnapshot(true) {
+    firstCommitWithSnapshot(true), checkpointFiles(checkpointFiles), checkpointSlot(1), commitCount(0),
+    checkpointPopCommit(-1), nextCheckpointTime(0), checkpointMinBytes(checkpointMinBytes),
+    checkpointInterval(checkpointInterval), snapshotsInLog(true), checkpointStartWriteBytes(0) {
 	// create reserved buffer for radixtree store type
 	this->reserved_buffer =
 	    (storeType == KeyValueStoreType::MEMORY) ? nullptr : new uint8_t[CLIENT_KNOBS->SYSTEM_KEY_SIZE_LIMIT];
@@ -740,10 +1129,15 @@ IKeyValueStore* keyValueStoreMemory(std::string const& basename, UID logID, int6
 	    .detail("StoreType", storeType);
 
 	IDiskQueue *log = openDiskQueue( basename, ext, logID, DiskQueueVersion::V1 );
+	std::vector<std::string> checkpointFiles = { basename + "checkpoint0." + ext + "c", basename + "checkpoint1." + ext + "c" };
 	if(storeType == KeyValueStoreType::MEMORY_RADIXTREE){
-		return new KeyValueStoreMemory<radix_tree>(log, logID, memoryLimit, storeType, false, false, false);
+		return new KeyValueStoreMemory<radix_tree>(log, logID, memoryLimit, storeType, false, false, false,
+		                                           checkpointFiles, SERVER_KNOBS->KVS_MEMORY_CHECKPOINT_MIN_BYTES,
+		                                           SERVER_KNOBS->KVS_MEMORY_CHECKPOINT_INTERVAL);
 	} else {
-		return new KeyValueStoreMemory<IKeyValueContainer>(log, logID, memoryLimit, storeType, false, false, false);
+		return new KeyValueStoreMemory<IKeyValueContainer>(log, logID, memoryLimit, storeType, false, false, false,
+		                                                   checkpointFiles, SERVER_KNOBS->KVS_MEMORY_CHECKPOINT_MIN_BYTES,
+		                                                   SERVER_KNOBS->KVS_MEMORY_CHECKPOINT_INTERVAL);
 	}
 }
 
@@ -751,3 +1145,105 @@ IKeyValueStore* keyValueStoreLogSystem( class IDiskQueue* queue, UID logID, int6
 	return new KeyValueStoreMemory<IKeyValueContainer>(queue, logID, memoryLimit, KeyValueStoreType::MEMORY,
 	                                                   disableSnapshot, replaceContent, exactRecovery);
 }
+
+static KeyValueStoreMemory<IKeyValueContainer>* openCheckpointTestStore(std::string basename,
+                                                                        std::vector<std::string> checkpointFiles,
+                                                                        int64_t checkpointMinBytes) {
+	UID id = deterministicRandom()->randomUniqueID();
+	return new KeyValueStoreMemory<IKeyValueContainer>(openDiskQueue(basename, "fdq", id, DiskQueueVersion::V1), id,
+	                                                   1e9, KeyValueStoreType::MEMORY, false, false, false,
+	                                                   checkpointFiles, checkpointMinBytes, 0);
+}
+
+ACTOR static Future<Void> closeCheckpointTestStore(IKeyValueStore* store, bool dispose) {
+	state Future<Void> closed = store->onClosed();
+	if (dispose) {
+		store->dispose();
+	} else {
+		store->close();
+	}
+	wait(closed);
+	return Void();
+}
+
+// Flips the bits of the checksum at the end of each checkpoint file
+ACTOR static Future<Void> corruptCheckpointChecksums(std::vector<std::string> filenames) {
+	state int i = 0;
+	for (; i < filenames.size(); i++) {
+		state Reference<IAsyncFile> file = wait(IAsyncFileSystem::filesystem()->open(
+		    filenames[i], IAsyncFile::OPEN_READWRITE | IAsyncFile::OPEN_UNCACHED, 0));
+		state int64_t size = wait(file->size());
+		state uint32_t checksum;
+		int bytesRead = wait(file->read(&checksum, sizeof(checksum), size - sizeof(checksum)));
+		ASSERT(bytesRead == sizeof(checksum));
+		checksum = ~checksum;
+		wait(file->write(&checksum, sizeof(checksum), size - sizeof(checksum)));
+		wait(file->sync());
+	}
+	return Void();
+}
+
+ACTOR static Future<Void> checkCheckpointTestStore(IKeyValueStore* store, std::map<Key, Value> expected) {
+	state Standalone<RangeResultRef> kvs = wait(store->readRange(allKeys, 1e6, 1e9));
+	ASSERT(kvs.size() == expected.size());
+	for (auto const& kv : kvs) {
+		auto it = expected.find(kv.key);
+		ASSERT(it != expected.end() && it->second == kv.value);
+	}
+	return Void();
+}
+
+TEST_CASE("/fdbserver/KeyValueStoreMemory/checkpoint") {
+	state std::string basename = "unittest_kvsmemcheckpoint-" + deterministicRandom()->randomUniqueID().toString() + "-";
+	state std::vector<std::string> checkpointFiles = { basename + "checkpoint0.fdqc", basename + "checkpoint1.fdqc" };
+	state KeyValueStoreMemory<IKeyValueContainer>* store = openCheckpointTestStore(basename, checkpointFiles, 1);
+	state KeyValueStoreMemory<IKeyValueContainer>* other;
+	state std::map<Key, Value> expected;
+	state int commits = 0;
+
+	// The log is first popped up to a checkpoint started at the end of an in-log snapshot, which the log may still
+	// hold a complete snapshot after, but no snapshot is written after the second
+	while (store->checkpointPops < 2) {
+		ASSERT(++commits < 100000);
+		for (int i = 0; i < 10; i++) {
+			Key key = StringRef(format("key%04d", deterministicRandom()->randomInt(0, 1000)));
+			Value value = StringRef(format("value%d", commits));
+			store->set(KeyValueRef(key, value), nullptr);
+			expected[key] = value;
+		}
+		wait(store->commit(false));
+	}
+	// The pop is durable once a later commit is
+	store->set(KeyValueRef(LiteralStringRef("key"), LiteralStringRef("value")), nullptr);
+	expected[LiteralStringRef("key")] = LiteralStringRef("value");
+	wait(store->commit(false));
+	wait(closeCheckpointTestStore(store, false));
+
+	store = openCheckpointTestStore(basename, checkpointFiles, 0);
+	wait(checkCheckpointTestStore(store, expected));
+	ASSERT(store->recoveredCheckpoint.present());
+	state IDiskQueue::location recoveredFrom = store->recoveredCheckpoint.get();
+
+	// Recovering the log from there again, but without its checkpoint, must not succeed.  The failures are checked
+	// on a store with an empty log, which loads no checkpoint itself, since recovering one that needs the checkpoint
+	// fails loudly.
+	wait(corruptCheckpointChecksums(checkpointFiles));
+	other = openCheckpointTestStore(basename + "other-", checkpointFiles, 0);
+	wait(checkCheckpointTestStore(other, std::map<Key, Value>()));
+	ASSERT(!other->recoveredCheckpoint.present());
+	try {
+		wait(success(other->loadCheckpointAt(recoveredFrom)));
+		ASSERT(false);
+	} catch (Error& e) {
+		ASSERT(e.code() == error_code_checksum_failed);
+	}
+
+	wait(IAsyncFileSystem::filesystem()->deleteFile(checkpointFiles[0], true));
+	wait(IAsyncFileSystem::filesystem()->deleteFile(checkpointFiles[1], true));
+	bool loaded = wait(other->loadCheckpointAt(recoveredFrom));
+	ASSERT(!loaded);
+
+	wait(closeCheckpointTestStore(other, true));
+	wait(closeCheckpointTestStore(store, true));
+	return Void();
+}
@@ -65,6 +65,12 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	init( TLOG_MESSAGE_BLOCK_OVERHEAD_FACTOR,      double(TLOG_MESSAGE_BLOCK_BYTES) / (TLOG_MESSAGE_BLOCK_BYTES - MAX_MESSAGE_SIZE) ); //1.0121466709838096006362758832473
 	init( PEEK_TRACKER_EXPIRATION_TIME,                          600 ); if( randomize && BUGGIFY ) PEEK_TRACKER_EXPIRATION_TIME = deterministicRandom()->coinflip() ? 0.1 : 60;
 	init( PARALLEL_GET_MORE_REQUESTS,                             32 ); if( randomize && BUGGIFY ) PARALLEL_GET_MORE_REQUESTS = 2;
+	init( PEEK_ADAPTIVE_WINDOW,                                 true ); if( randomize && BUGGIFY ) PEEK_ADAPTIVE_WINDOW = deterministicRandom()->coinflip();
+	init( PEEK_MIN_PARALLEL_REQUESTS,                              2 ); if( randomize && BUGGIFY ) PEEK_MIN_PARALLEL_REQUESTS = 1;
+	init( PEEK_LATENCY_FILTER_PERIOD,                           10.0 ); if( randomize && BUGGIFY ) PEEK_LATENCY_FILTER_PERIOD = 0.5;
+	init( PEEK_BANDWIDTH_FOLDING_TIME,                           1.0 );
+	init( STORAGE_SERVER_PARALLEL_PEEKS,                        false ); if( randomize && BUGGIFY ) STORAGE_SERVER_PARALLEL_PEEKS = true;
+	init( STORAGE_SERVER_PARALLEL_PEEK_BYTES,                    1e6 ); if( randomize && BUGGIFY ) STORAGE_SERVER_PARALLEL_PEEK_BYTES = 1;
 	init( MULTI_CURSOR_PRE_FETCH_LIMIT,                           10 );
 	init( MAX_QUEUE_COMMIT_BYTES,                               15e6 ); if( randomize && BUGGIFY ) MAX_QUEUE_COMMIT_BYTES = 5000;
 	init( DESIRED_OUTSTANDING_MESSAGES,                         5000 ); if( randomize && BUGGIFY ) DESIRED_OUTSTANDING_MESSAGES = deterministicRandom()->randomInt(0,100);
@@ -79,6 +85,7 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	init( DISK_QUEUE_FILE_EXTENSION_BYTES,                    10<<20 ); // BUGGIFYd per file within the DiskQueue
 	init( DISK_QUEUE_FILE_SHRINK_BYTES,                      100<<20 ); // BUGGIFYd per file within the DiskQueue
 	init( DISK_QUEUE_MAX_TRUNCATE_BYTES,                       2<<30 ); if ( randomize && BUGGIFY ) DISK_QUEUE_MAX_TRUNCATE_BYTES = 0;
+	init( DISK_QUEUE_GROUP_COMMIT_MAX_BYTES,                  16<<20 ); if ( randomize && BUGGIFY ) DISK_QUEUE_GROUP_COMMIT_MAX_BYTES = deterministicRandom()->coinflip() ? 0 : 8<<10;
 	init( TLOG_DEGRADED_DURATION,                                5.0 );
 	init( MAX_CACHE_VERSIONS,                                   10e6 );
 	init( TLOG_IGNORE_POP_AUTO_ENABLE_DELAY,                   300.0 );
@@ -94,6 +101,9 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	init( BG_REBALANCE_SWITCH_CHECK_INTERVAL,                    5.0 ); if (randomize && BUGGIFY) BG_REBALANCE_SWITCH_CHECK_INTERVAL = 1.0;
 	init( DD_QUEUE_LOGGING_INTERVAL,                             5.0 );
 	init( RELOCATION_PARALLELISM_PER_SOURCE_SERVER,                2 ); if( randomize && BUGGIFY ) RELOCATION_PARALLELISM_PER_SOURCE_SERVER = 1;
+	init( DD_RELOCATION_FETCH_BYTES_PER_SECOND,                 20e6 );
+	init( DD_MAX_RELOCATION_COST_PER_SERVER,                     1e9 ); if( randomize && BUGGIFY ) DD_MAX_RELOCATION_COST_PER_SERVER = 1e6;
+	init( DD_RELOCATION_COST_RECHECK_DELAY,                      1.0 ); if( randomize && BUGGIFY ) DD_RELOCATION_COST_RECHECK_DELAY = 0.1;
 	init( DD_QUEUE_MAX_KEY_SERVERS,                              100 ); if( randomize && BUGGIFY ) DD_QUEUE_MAX_KEY_SERVERS = 1;
 	init( DD_REBALANCE_PARALLELISM,                               50 );
 	init( DD_REBALANCE_RESET_AMOUNT,                              30 );
@@ -279,6 +289,14 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 
 	// KeyValueStoreMemory
 	init( REPLACE_CONTENTS_BYTES,                                1e5 );
+	init( KVS_MEMORY_CHECKPOINT_MIN_BYTES,                         0 ); if( randomize && BUGGIFY ) KVS_MEMORY_CHECKPOINT_MIN_BYTES = 1;
+	init( KVS_MEMORY_CHECKPOINT_INTERVAL,                      600.0 ); if( randomize && BUGGIFY ) KVS_MEMORY_CHECKPOINT_INTERVAL = deterministicRandom()->random01() * 10.0;
+	init( KVS_MEMORY_CHECKPOINT_BATCH_BYTES,                     1e6 ); if( randomize && BUGGIFY ) KVS_MEMORY_CHECKPOINT_BATCH_BYTES = deterministicRandom()->randomInt(100, 10000);
+
+	// KeyValueStoreRedwood
+	init( REDWOOD_VALUE_COMPRESSION,                               0 ); if( randomize && BUGGIFY ) REDWOOD_VALUE_COMPRESSION = 1;
+	init( REDWOOD_VALUE_COMPRESSION_MIN_BYTES,                    64 ); if( randomize && BUGGIFY ) REDWOOD_VALUE_COMPRESSION_MIN_BYTES = deterministicRandom()->randomInt(0, 100);
+	init( REDWOOD_VALUE_COMPRESSION_LEVEL,                         1 );
 
 	// Leader election
 	bool longLeaderElection = randomize && BUGGIFY;
@@ -306,6 +324,13 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	init( COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION,     0.1 );
 	init( COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA,       0.1 );
 	init( COMMIT_TRANSACTION_BATCH_COUNT_MAX,                   32768 ); if( randomize && BUGGIFY ) COMMIT_TRANSACTION_BATCH_COUNT_MAX = 1000; // Do NOT increase this number beyond 32768, as CommitIds only budget 2 bytes for storing transaction id within each batch
+	init( COMMIT_BATCH_LATENCY_TARGET,                            0.0 ); if( randomize && BUGGIFY ) COMMIT_BATCH_LATENCY_TARGET = deterministicRandom()->coinflip() ? 0.05 : 0.5; // p99 commit latency the batcher aims for; <= 0 sizes batches with the smoothed COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION heuristic instead
+	init( COMMIT_BATCH_CONTROL_WINDOW,                            1.0 ); if( randomize && BUGGIFY ) COMMIT_BATCH_CONTROL_WINDOW = 0.1;
+	init( COMMIT_BATCH_CONTROL_MIN_SAMPLES,                       100 ); if( randomize && BUGGIFY ) COMMIT_BATCH_CONTROL_MIN_SAMPLES = 1;
+	init( COMMIT_BATCH_CONTROL_HEADROOM,                          0.8 );
+	init( COMMIT_BATCH_CONTROL_INTERVAL_STEP,                  0.0005 );
+	init( COMMIT_BATCH_CONTROL_DECREASE_RATIO,                    0.5 );
+	init( COMMIT_BATCH_CONTROL_MIN_COUNT,                          64 ); if( randomize && BUGGIFY ) COMMIT_BATCH_CONTROL_MIN_COUNT = 1;
 	init( COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT,              8LL << 30 ); if (randomize && BUGGIFY) COMMIT_BATCHES_MEM_BYTES_HARD_LIMIT = deterministicRandom()->randomInt64(100LL << 20,  8LL << 30);
 	init( COMMIT_BATCHES_MEM_FRACTION_OF_TOTAL,                   0.5 );
 	init( COMMIT_BATCHES_MEM_TO_TOTAL_MEM_SCALE_FACTOR,          10.0 );
@@ -355,12 +380,15 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	init( SAMPLE_EXPIRATION_TIME,                                1.0 );
 	init( SAMPLE_POLL_TIME,                                      0.1 );
 	init( RESOLVER_STATE_MEMORY_LIMIT,                           1e6 );
+	init( RESOLVER_CONFLICT_SET_GENERATIONS,                       4 ); if( randomize && BUGGIFY ) RESOLVER_CONFLICT_SET_GENERATIONS = deterministicRandom()->randomInt(1, 20);
 	init( LAST_LIMITED_RATIO,                                    2.0 );
 
 	// Backup Worker
 	init( BACKUP_TIMEOUT,                                        0.4 );
 	init( BACKUP_NOOP_POP_DELAY,                                 5.0 );
 	init( BACKUP_FILE_BLOCK_BYTES,                       1024 * 1024 );
+	init( BACKUP_WORKER_PARALLEL_FILES,                            8 ); if( randomize && BUGGIFY ) BACKUP_WORKER_PARALLEL_FILES = deterministicRandom()->randomInt(1, 4);
+	init( BACKUP_WORKER_MIN_FILE_BYTES,                          1e6 ); if( randomize && BUGGIFY ) BACKUP_WORKER_MIN_FILE_BYTES = 1000;
 
 	//Cluster Controller
 	init( CLUSTER_CONTROLLER_LOGGING_DELAY,                      5.0 );
@@ -387,6 +415,7 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	init( REPLACE_INTERFACE_CHECK_DELAY,                         5.0 );
 	init( COORDINATOR_REGISTER_INTERVAL,                         5.0 );
 	init( CLIENT_REGISTER_INTERVAL,                            600.0 );
+	init( SERVER_DBINFO_HISTORY,                                  20 ); if( randomize && BUGGIFY ) SERVER_DBINFO_HISTORY = deterministicRandom()->randomInt(0, 3);
 
 	init( INCOMPATIBLE_PEERS_LOGGING_INTERVAL,                   600 ); if( randomize && BUGGIFY ) INCOMPATIBLE_PEERS_LOGGING_INTERVAL = 60.0;
 	init( EXPECTED_MASTER_FITNESS,            ProcessClass::UnsetFit );
@@ -502,6 +531,20 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	init( BEHIND_CHECK_COUNT,                                      2 );
 	init( BEHIND_CHECK_VERSIONS,             5 * VERSIONS_PER_SECOND );
 	init( WAIT_METRICS_WRONG_SHARD_CHANCE,   isSimulated ? 1.0 : 0.1 );
+	init( HOT_VALUE_CACHE_BYTES,                                   0 ); if( randomize && BUGGIFY ) HOT_VALUE_CACHE_BYTES = deterministicRandom()->coinflip() ? 1e6 : 1e3;
+	init( HOT_VALUE_CACHE_SAMPLE_INTERVAL,                       1.0 );
+	init( HOT_VALUE_CACHE_MIN_READS,                              50 ); if( randomize && BUGGIFY ) HOT_VALUE_CACHE_MIN_READS = 1;
+	init( HOT_VALUE_CACHE_MAX_TRACKED_KEYS,                    10000 );
+	init( HOT_VALUE_CACHE_MAX_VALUE_BYTES,                     10000 );
+	init( STORAGE_BLOOM_FILTER_BYTES,                              0 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_BYTES = deterministicRandom()->coinflip() ? 1e6 : 100;
+	init( STORAGE_BLOOM_FILTER_HASHES,                             7 );
+	init( STORAGE_BLOOM_FILTER_REBUILD_FALSE_POSITIVE_RATE,     0.05 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_REBUILD_FALSE_POSITIVE_RATE = 0.0;
+	init( STORAGE_BLOOM_FILTER_REBUILD_DELAY,                   60.0 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_REBUILD_DELAY = 1.0;
+	init( STORAGE_BLOOM_FILTER_REBUILD_MIN_SAMPLES,             1000 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_REBUILD_MIN_SAMPLES = 1;
+	init( STORAGE_BLOOM_FILTER_SCAN_BYTES,                       1e6 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_SCAN_BYTES = 1000;
+	init( STORAGE_BLOOM_FILTER_SCAN_BYTES_PER_SECOND,            1e7 ); if( randomize && BUGGIFY ) STORAGE_BLOOM_FILTER_SCAN_BYTES_PER_SECOND = 1e5;
+	init( STORAGE_CACHE_COMPACTION_INTERVAL,                     1.0 ); if( randomize && BUGGIFY ) STORAGE_CACHE_COMPACTION_INTERVAL = 0.0;
+	init( STORAGE_CACHE_COMPACTION_NODES_PER_YIELD,             1000 ); if( randomize && BUGGIFY ) STORAGE_CACHE_COMPACTION_NODES_PER_YIELD = 1;
 
 	//Wait Failure
 	init( MAX_OUTSTANDING_WAIT_FAILURE_REQUESTS,                 250 ); if( randomize && BUGGIFY ) MAX_OUTSTANDING_WAIT_FAILURE_REQUESTS = 2;
@@ -530,6 +573,9 @@ ServerKnobs::ServerKnobs(bool randomize, ClientKnobs* clientKnobs, bool isSimula
 	// Status
 	init( STATUS_MIN_TIME_BETWEEN_REQUESTS,                      0.0 );
 	init( MAX_STATUS_REQUESTS_PER_SECOND,                      256.0 );
+	init( STATUS_REPLY_CACHE_TTL,                                1.0 ); if( randomize && BUGGIFY ) STATUS_REPLY_CACHE_TTL = deterministicRandom()->coinflip() ? 0.0 : 5.0;
+	init( STATUS_METRICS_EVENT_TTL,                              2.0 ); if( randomize && BUGGIFY ) STATUS_METRICS_EVENT_TTL = deterministicRandom()->coinflip() ? 0.0 : 10.0;
+	init( STATUS_STATIC_EVENT_TTL,                              60.0 ); if( randomize && BUGGIFY ) STATUS_STATIC_EVENT_TTL = 0.0;
 	init( CONFIGURATION_ROWS_TO_FETCH,                         20000 );
 	init( DISABLE_DUPLICATE_LOG_WARNING,                       false );
 
@@ -68,6 +68,12 @@ public:
 	int LOG_SYSTEM_PUSHED_DATA_BLOCK_SIZE;
 	double PEEK_TRACKER_EXPIRATION_TIME;
 	int PARALLEL_GET_MORE_REQUESTS;
+	bool PEEK_ADAPTIVE_WINDOW;
+	int PEEK_MIN_PARALLEL_REQUESTS;
+	double PEEK_LATENCY_FILTER_PERIOD;
+	double PEEK_BANDWIDTH_FOLDING_TIME;
+	bool STORAGE_SERVER_PARALLEL_PEEKS; // Storage servers keep sequenced peeks outstanding, so the TLog answers each as soon as a commit lands
+	int64_t STORAGE_SERVER_PARALLEL_PEEK_BYTES; // Storage servers keep no more peeks outstanding than would return this many bytes at DESIRED_TOTAL_BYTES each
 	int MULTI_CURSOR_PRE_FETCH_LIMIT;
 	int64_t MAX_QUEUE_COMMIT_BYTES;
 	int DESIRED_OUTSTANDING_MESSAGES;
@@ -82,6 +88,7 @@ public:
 	int64_t DISK_QUEUE_FILE_EXTENSION_BYTES; // When we grow the disk queue, by how many bytes should it grow?
 	int64_t DISK_QUEUE_FILE_SHRINK_BYTES; // When we shrink the disk queue, by how many bytes should it shrink?
 	int DISK_QUEUE_MAX_TRUNCATE_BYTES;  // A truncate larger than this will cause the file to be replaced instead.
+	int64_t DISK_QUEUE_GROUP_COMMIT_MAX_BYTES; // Commits issued while an earlier commit is syncing are merged into one write and sync up to this size, 0 disables merging
 	double TLOG_DEGRADED_DURATION;
 	int64_t MAX_CACHE_VERSIONS;
 	double TXS_POPPED_MAX_DELAY;
@@ -93,6 +100,9 @@ public:
 	double BG_REBALANCE_SWITCH_CHECK_INTERVAL;
 	double DD_QUEUE_LOGGING_INTERVAL;
 	double RELOCATION_PARALLELISM_PER_SOURCE_SERVER;
+	double DD_RELOCATION_FETCH_BYTES_PER_SECOND; // Assumed rate at which a destination server writes fetched data
+	int64_t DD_MAX_RELOCATION_COST_PER_SERVER; // Rebalancing waits rather than exceed this estimated fetch cost on a server
+	double DD_RELOCATION_COST_RECHECK_DELAY;
 	int DD_QUEUE_MAX_KEY_SERVERS;
 	int DD_REBALANCE_PARALLELISM;
 	int DD_REBALANCE_RESET_AMOUNT;
@@ -225,6 +235,17 @@ public:
 
 	// KeyValueStoreMemory
 	int64_t REPLACE_CONTENTS_BYTES;
+	// Stores holding less data than this recover from their log alone, and 0 turns checkpoints off.  Once a store has
+	// written a checkpoint its log no longer holds a snapshot, so a version that doesn't read checkpoints can't recover
+	// it: turn this off and let each store write a complete in-log snapshot before downgrading.
+	int64_t KVS_MEMORY_CHECKPOINT_MIN_BYTES;
+	double KVS_MEMORY_CHECKPOINT_INTERVAL; // Minimum time between starting two checkpoints
+	int KVS_MEMORY_CHECKPOINT_BATCH_BYTES; // Size of each write to, and read from, a checkpoint file
+
+	// KeyValueStoreRedwood
+	int REDWOOD_VALUE_COMPRESSION; // Whether newly created Redwood stores compress values; existing stores keep the setting they were created with
+	int REDWOOD_VALUE_COMPRESSION_MIN_BYTES;
+	int REDWOOD_VALUE_COMPRESSION_LEVEL; // zlib compression level, 1 (fastest) to 9 (smallest)
 
 	// Leader election
 	int MAX_NOTIFICATIONS;
@@ -251,6 +272,13 @@ public:
 	double COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
 	double COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA;
 	int    COMMIT_TRANSACTION_BATCH_COUNT_MAX;
+	double COMMIT_BATCH_LATENCY_TARGET;
+	double COMMIT_BATCH_CONTROL_WINDOW;
+	int    COMMIT_BATCH_CONTROL_MIN_SAMPLES;
+	double COMMIT_BATCH_CONTROL_HEADROOM; // The batch interval and size only grow while the p99 is below this fraction of the target
+	double COMMIT_BATCH_CONTROL_INTERVAL_STEP;
+	double COMMIT_BATCH_CONTROL_DECREASE_RATIO;
+	int    COMMIT_BATCH_CONTROL_MIN_COUNT;
 	int    COMMIT_TRANSACTION_BATCH_BYTES_MIN;
 	int    COMMIT_TRANSACTION_BATCH_BYTES_MAX;
 	double COMMIT_TRANSACTION_BATCH_BYTES_SCALE_BASE;
@@ -293,11 +321,14 @@ public:
 	double SAMPLE_EXPIRATION_TIME;
 	double SAMPLE_POLL_TIME;
 	int64_t RESOLVER_STATE_MEMORY_LIMIT;
+	int RESOLVER_CONFLICT_SET_GENERATIONS; // The write conflict history is kept in about this many generations plus one, each dropped whole once it is too old
 
 	// Backup Worker
 	double BACKUP_TIMEOUT;  // master's reaction time for backup failure
 	double BACKUP_NOOP_POP_DELAY;
 	int BACKUP_FILE_BLOCK_BYTES;
+	int BACKUP_WORKER_PARALLEL_FILES; // Maximum number of mutation log files a backup worker writes at once for each backup
+	int64_t BACKUP_WORKER_MIN_FILE_BYTES; // Smallest mutation log file a backup worker splits its messages into; 0 for no minimum
 
 	//Cluster Controller
 	double CLUSTER_CONTROLLER_LOGGING_DELAY;
@@ -325,6 +356,7 @@ public:
 	double REPLACE_INTERFACE_CHECK_DELAY;
 	double COORDINATOR_REGISTER_INTERVAL;
 	double CLIENT_REGISTER_INTERVAL;
+	int SERVER_DBINFO_HISTORY; // Number of recent ServerDBInfos the cluster controller can send workers deltas from
 
 	// Knobs used to select the best policy (via monte carlo)
 	int POLICY_RATING_TESTS;	// number of tests per policy (in order to compare)
@@ -441,6 +473,20 @@ public:
 	int BEHIND_CHECK_COUNT;
 	int64_t BEHIND_CHECK_VERSIONS;
 	double WAIT_METRICS_WRONG_SHARD_CHANCE;
+	int64_t HOT_VALUE_CACHE_BYTES; // 0 disables the storage server hot value cache
+	double HOT_VALUE_CACHE_SAMPLE_INTERVAL;
+	int HOT_VALUE_CACHE_MIN_READS; // A key is cached once it is read this many times in one sample interval
+	int HOT_VALUE_CACHE_MAX_TRACKED_KEYS;
+	int HOT_VALUE_CACHE_MAX_VALUE_BYTES;
+	int64_t STORAGE_BLOOM_FILTER_BYTES; // 0 disables the bloom filter over the keys of each ssd and redwood storage server
+	int STORAGE_BLOOM_FILTER_HASHES; // Used until the filter has been built once and the number of keys is known
+	double STORAGE_BLOOM_FILTER_REBUILD_FALSE_POSITIVE_RATE;
+	double STORAGE_BLOOM_FILTER_REBUILD_DELAY;
+	int STORAGE_BLOOM_FILTER_REBUILD_MIN_SAMPLES; // Reads of missing keys needed between checks to measure the false positive rate
+	int STORAGE_BLOOM_FILTER_SCAN_BYTES;
+	double STORAGE_BLOOM_FILTER_SCAN_BYTES_PER_SECOND; // Limits how fast a build reads the store, which it does in full after each start
+	double STORAGE_CACHE_COMPACTION_INTERVAL;
+	int STORAGE_CACHE_COMPACTION_NODES_PER_YIELD;
 
 	//Wait Failure
 	int MAX_OUTSTANDING_WAIT_FAILURE_REQUESTS;
@@ -469,6 +515,9 @@ public:
 	// Status
 	double STATUS_MIN_TIME_BETWEEN_REQUESTS;
 	double MAX_STATUS_REQUESTS_PER_SECOND;
+	double STATUS_REPLY_CACHE_TTL; // Status requests arriving within this long of the last status being generated are answered with it
+	double STATUS_METRICS_EVENT_TTL; // How long periodically logged worker events (e.g. ProcessMetrics) are reused for status
+	double STATUS_STATIC_EVENT_TTL; // How long worker events which rarely change (e.g. ProgramStart) are reused for status
 	int CONFIGURATION_ROWS_TO_FETCH;
 	bool DISABLE_DUPLICATE_LOG_WARNING;
 
@@ -31,6 +31,7 @@
 #include "fdbrpc/ReplicationPolicy.h"
 #include "fdbrpc/Locality.h"
 #include "fdbrpc/Replication.h"
+#include "fdbrpc/Smoother.h"
 
 struct DBCoreState;
 struct TLogSet;
@@ -402,9 +403,20 @@ struct ILogSystem {
 		bool parallelGetMore;
 		int sequence;
 		Deque<Future<TLogPeekReply>> futureResults;
+		Deque<double> requestTimes; // When each of futureResults was sent
 		Future<Void> interfaceChanged;
 
-		ServerPeekCursor( Reference<AsyncVar<OptionalInterface<TLogInterface>>> const& interf, Tag tag, Version begin, Version end, bool returnIfBlocked, bool parallelGetMore );
+		// With parallelGetMore, the number of peeks kept outstanding is sized to the bandwidth-delay product of the
+		// link to the TLog: the smoothed rate of peeked bytes times the lowest recently observed peek latency.
+		int getMoreWindow;
+		int maxGetMoreWindow; // Bounds the replies buffered while they wait to be consumed
+		Smoother peekedBytes;
+		double minLatency, prevMinLatency, latencyPeriodStart;
+
+		void updateGetMoreWindow( double latency, int64_t bytes );
+
+		// maxGetMoreWindow defaults to PARALLEL_GET_MORE_REQUESTS
+		ServerPeekCursor( Reference<AsyncVar<OptionalInterface<TLogInterface>>> const& interf, Tag tag, Version begin, Version end, bool returnIfBlocked, bool parallelGetMore, int maxGetMoreWindow = 0 );
 		ServerPeekCursor( TLogPeekReply const& results, LogMessageVersion const& messageVersion, LogMessageVersion const& end, TagsAndMessage const& message, bool hasMsg, Version poppedVersion, Tag tag );
 
 		virtual Reference<IPeekCursor> cloneNoMore();
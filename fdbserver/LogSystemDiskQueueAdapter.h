@@ -84,6 +84,7 @@ public:
 	virtual IDiskQueue::location getNextReadLocation();
 	virtual IDiskQueue::location getNextCommitLocation() { ASSERT(false); throw internal_error(); }
 	virtual IDiskQueue::location getNextPushLocation() { ASSERT(false); throw internal_error(); }
+	virtual IDiskQueue::location getReadLocationAfterPop( location popped ) { return popped; }
 	virtual Future<Standalone<StringRef>> read( location start, location end, CheckHashes ch ) { ASSERT(false); throw internal_error(); }
 	virtual IDiskQueue::location push( StringRef contents );
 	virtual void pop( IDiskQueue::location upTo );
@@ -24,15 +24,19 @@
 #include "fdbrpc/ReplicationUtils.h"
 #include "flow/actorcompiler.h" // has to be last include
 
-ILogSystem::ServerPeekCursor::ServerPeekCursor( Reference<AsyncVar<OptionalInterface<TLogInterface>>> const& interf, Tag tag, Version begin, Version end, bool returnIfBlocked, bool parallelGetMore )
-			: interf(interf), tag(tag), messageVersion(begin), end(end), hasMsg(false), rd(results.arena, results.messages, Unversioned()), randomID(deterministicRandom()->randomUniqueID()), poppedVersion(0), returnIfBlocked(returnIfBlocked), sequence(0), onlySpilled(false), parallelGetMore(parallelGetMore) {
+ILogSystem::ServerPeekCursor::ServerPeekCursor( Reference<AsyncVar<OptionalInterface<TLogInterface>>> const& interf, Tag tag, Version begin, Version end, bool returnIfBlocked, bool parallelGetMore, int maxGetMoreWindow )
+			: interf(interf), tag(tag), messageVersion(begin), end(end), hasMsg(false), rd(results.arena, results.messages, Unversioned()), randomID(deterministicRandom()->randomUniqueID()), poppedVersion(0), returnIfBlocked(returnIfBlocked), sequence(0), onlySpilled(false), parallelGetMore(parallelGetMore),
+			  maxGetMoreWindow(maxGetMoreWindow > 0 ? std::min(maxGetMoreWindow, SERVER_KNOBS->PARALLEL_GET_MORE_REQUESTS) : SERVER_KNOBS->PARALLEL_GET_MORE_REQUESTS),
+			  peekedBytes(SERVER_KNOBS->PEEK_BANDWIDTH_FOLDING_TIME), minLatency(0), prevMinLatency(0), latencyPeriodStart(0) {
+	getMoreWindow = this->maxGetMoreWindow;
 	this->results.maxKnownVersion = 0;
 	this->results.minKnownCommittedVersion = 0;
 	//TraceEvent("SPC_Starting", randomID).detail("Tag", tag.toString()).detail("Begin", begin).detail("End", end).backtrace();
 }
 
 ILogSystem::ServerPeekCursor::ServerPeekCursor( TLogPeekReply const& results, LogMessageVersion const& messageVersion, LogMessageVersion const& end, TagsAndMessage const& message, bool hasMsg, Version poppedVersion, Tag tag )
-			: results(results), tag(tag), rd(results.arena, results.messages, Unversioned()), messageVersion(messageVersion), end(end), messageAndTags(message), hasMsg(hasMsg), randomID(deterministicRandom()->randomUniqueID()), poppedVersion(poppedVersion), returnIfBlocked(false), sequence(0), onlySpilled(false), parallelGetMore(false)
+			: results(results), tag(tag), rd(results.arena, results.messages, Unversioned()), messageVersion(messageVersion), end(end), messageAndTags(message), hasMsg(hasMsg), randomID(deterministicRandom()->randomUniqueID()), poppedVersion(poppedVersion), returnIfBlocked(false), sequence(0), onlySpilled(false), parallelGetMore(false),
+			  getMoreWindow(SERVER_KNOBS->PARALLEL_GET_MORE_REQUESTS), maxGetMoreWindow(SERVER_KNOBS->PARALLEL_GET_MORE_REQUESTS), peekedBytes(SERVER_KNOBS->PEEK_BANDWIDTH_FOLDING_TIME), minLatency(0), prevMinLatency(0), latencyPeriodStart(0)
 {
 	//TraceEvent("SPC_Clone", randomID);
 	this->results.maxKnownVersion = 0;
@@ -131,6 +135,30 @@ void ILogSystem::ServerPeekCursor::advanceTo(LogMessageVersion n) {
 	}
 }
 
+void ILogSystem::ServerPeekCursor::updateGetMoreWindow( double latency, int64_t bytes ) {
+	if( !SERVER_KNOBS->PEEK_ADAPTIVE_WINDOW ) {
+		getMoreWindow = maxGetMoreWindow;
+		return;
+	}
+
+	// Peeks that wait at the TLog for new commits or behind earlier peeks overstate the round trip, so the latency
+	// estimate is a minimum over the current and previous filter periods.
+	if( latencyPeriodStart == 0 || now() - latencyPeriodStart > SERVER_KNOBS->PEEK_LATENCY_FILTER_PERIOD ) {
+		prevMinLatency = latencyPeriodStart == 0 ? latency : minLatency;
+		minLatency = latency;
+		latencyPeriodStart = now();
+	} else {
+		minLatency = std::min( minLatency, latency );
+	}
+	peekedBytes.addDelta( bytes );
+
+	// A window that limits throughput shows up as bandwidth of about one full reply per outstanding peek per round
+	// trip, so the extra request lets the window keep growing until the TLog or this process is the bottleneck.
+	double bandwidthDelay = peekedBytes.smoothRate() * std::min( minLatency, prevMinLatency );
+	int window = std::ceil( bandwidthDelay / SERVER_KNOBS->DESIRED_TOTAL_BYTES ) + 1;
+	getMoreWindow = std::min( maxGetMoreWindow, std::max( SERVER_KNOBS->PEEK_MIN_PARALLEL_REQUESTS, window ) );
+}
+
 ACTOR Future<Void> serverPeekParallelGetMore( ILogSystem::ServerPeekCursor* self, TaskPriority taskID ) {
 	if( !self->interf || self->messageVersion >= self->end ) {
 		if( self->hasMessage() )
@@ -147,8 +175,9 @@ ACTOR Future<Void> serverPeekParallelGetMore( ILogSystem::ServerPeekCursor* self
 		state Version expectedBegin = self->messageVersion.version;
 		try {
 			if (self->parallelGetMore || self->onlySpilled) {
-				while(self->futureResults.size() < SERVER_KNOBS->PARALLEL_GET_MORE_REQUESTS && self->interf->get().present()) {
+				while(self->futureResults.size() < self->getMoreWindow && self->interf->get().present()) {
 					self->futureResults.push_back( brokenPromiseToNever( self->interf->get().interf().peekMessages.getReply(TLogPeekRequest(self->messageVersion.version,self->tag,self->returnIfBlocked, self->onlySpilled, std::make_pair(self->randomID, self->sequence++)), taskID) ) );
+					self->requestTimes.push_back( now() );
 				}
 				if (self->sequence == std::numeric_limits<decltype(self->sequence)>::max()) {
 					throw operation_obsolete();
@@ -167,6 +196,8 @@ ACTOR Future<Void> serverPeekParallelGetMore( ILogSystem::ServerPeekCursor* self
 					}
 					expectedBegin = res.end;
 					self->futureResults.pop_front();
+					self->updateGetMoreWindow( now() - self->requestTimes.front(), res.messages.size() );
+					self->requestTimes.pop_front();
 					self->results = res;
 					self->onlySpilled = res.onlySpilled;
 					if(res.popped.present())
@@ -185,6 +216,7 @@ ACTOR Future<Void> serverPeekParallelGetMore( ILogSystem::ServerPeekCursor* self
 					self->sequence = 0;
 					self->onlySpilled = false;
 					self->futureResults.clear();
+					self->requestTimes.clear();
 				}
 			}
 		} catch( Error &e ) {
@@ -200,6 +232,7 @@ ACTOR Future<Void> serverPeekParallelGetMore( ILogSystem::ServerPeekCursor* self
 				self->randomID = deterministicRandom()->randomUniqueID();
 				self->sequence = 0;
 				self->futureResults.clear();
+				self->requestTimes.clear();
 			} else {
 				throw e;
 			}
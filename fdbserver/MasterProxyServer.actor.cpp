@@ -43,9 +43,11 @@
 #include "fdbserver/WaitFailure.h"
 #include "fdbserver/WorkerInterface.actor.h"
 #include "flow/ActorCollection.h"
+#include "flow/Histogram.h"
 #include "flow/Knobs.h"
 #include "flow/Stats.h"
 #include "flow/TDMetric.actor.h"
+#include "flow/UnitTest.h"
 #include "flow/actorcompiler.h"  // This must be the last #include.
 
 struct ProxyStats {
@@ -228,6 +230,119 @@ DESCR struct SingleKeyMutation {
 	int64_t tag3;
 };
 
+// When each phase of a commit batch finished, in g_network->timer() seconds
+struct CommitBatchPhaseTimes {
+	double oldestRequest; // When the oldest transaction in the batch arrived at the proxy
+	double start; // When the batcher released the batch
+	double resolved; // Includes getting the commit version from the master
+	double logStart;
+	double logged;
+	double replied;
+};
+
+// Chooses the commit batch interval and the maximum number of transactions in a batch so that the p99 commit latency
+// measured at the proxy stays under COMMIT_BATCH_LATENCY_TARGET.  Within that target bigger batches are better,
+// because every batch costs a master version request, a resolution round trip and a TLog push no matter its size.
+//
+// Once per COMMIT_BATCH_CONTROL_WINDOW the p99 of the window is compared with the target.  Over the target the interval
+// is cut by COMMIT_BATCH_CONTROL_DECREASE_RATIO, and once it is at the minimum so is the batch size, but only while
+// waiting in the batcher accounts for the excess.  When it is the rest of the pipeline that is slow, the cluster is
+// overloaded and more, smaller batches would only add per-batch work, so nothing changes; nor is the batch size ever
+// cut below what arrives in one interval at the window's throughput.  Comfortably under
+// the target the interval grows by COMMIT_BATCH_CONTROL_INTERVAL_STEP and the batch size doubles.  The interval is also
+// never allowed past the part of the target the rest of the pipeline leaves over (the p99 of resolution, logging and
+// replying), since every transaction can wait up to a whole interval in the batcher.
+struct CommitBatchController {
+	LatencyHistogram commitLatency; // Per transaction, from arrival at the proxy to the reply
+	LatencyHistogram queueing, resolution, logging, reply, pipeline; // Per batch
+	int64_t batches, transactions;
+	double windowStart;
+
+	double target;
+	double interval;
+	int countLimit;
+
+	CommitBatchController()
+	  : batches(0), transactions(0), windowStart(0), target(SERVER_KNOBS->COMMIT_BATCH_LATENCY_TARGET),
+	    interval(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN),
+	    countLimit(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX) {}
+
+	static bool enabled() { return SERVER_KNOBS->COMMIT_BATCH_LATENCY_TARGET > 0; }
+
+	void addBatch(CommitBatchPhaseTimes const& t, vector<CommitTransactionRequest> const& trs) {
+		for (auto& tr : trs) commitLatency.addMeasurement(t.replied - tr.requestTime());
+		queueing.addMeasurement(t.start - t.oldestRequest);
+		resolution.addMeasurement(t.resolved - t.start);
+		logging.addMeasurement(t.logged - t.logStart);
+		reply.addMeasurement(t.replied - t.logged);
+		pipeline.addMeasurement(t.replied - t.start);
+		batches++;
+		transactions += trs.size();
+	}
+
+	// Adjusts the interval and count limit if the current window is over and measured enough transactions
+	void update(UID proxyId, double now) {
+		if (windowStart == 0) windowStart = now;
+		if (now - windowStart < SERVER_KNOBS->COMMIT_BATCH_CONTROL_WINDOW ||
+		    commitLatency.count() < SERVER_KNOBS->COMMIT_BATCH_CONTROL_MIN_SAMPLES)
+			return;
+
+		double p99 = commitLatency.percentile(0.99);
+		double budget = target - pipeline.percentile(0.99);
+		double transactionsPerSecond = transactions / (now - windowStart);
+		const char* decision = decide(p99, budget, queueing.percentile(0.99), transactionsPerSecond);
+
+		TraceEvent("CommitBatchControl", proxyId)
+		    .detail("Decision", decision)
+		    .detail("TargetP99", target)
+		    .detail("CommitP99", p99)
+		    .detail("QueueingP99", queueing.percentile(0.99))
+		    .detail("ResolutionP99", resolution.percentile(0.99))
+		    .detail("LoggingP99", logging.percentile(0.99))
+		    .detail("ReplyP99", reply.percentile(0.99))
+		    .detail("IntervalBudget", budget)
+		    .detail("Interval", interval)
+		    .detail("CountLimit", countLimit)
+		    .detail("Batches", batches)
+		    .detail("TransactionsPerSecond", transactionsPerSecond);
+
+		for (auto h : { &commitLatency, &queueing, &resolution, &logging, &reply, &pipeline }) h->clear();
+		batches = transactions = 0;
+		windowStart = now;
+	}
+
+	// Applies one control step given the p99 commit latency, the largest interval the pipeline leaves room for, the p99
+	// time batches waited in the batcher, and the throughput
+	const char* decide(double p99, double budget, double queueingP99, double transactionsPerSecond) {
+		const char* decision = "Hold";
+		int minCount = std::max<int64_t>(SERVER_KNOBS->COMMIT_BATCH_CONTROL_MIN_COUNT,
+		                                 std::min<double>(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX,
+		                                                  std::ceil(transactionsPerSecond * interval)));
+		if (p99 > target) {
+			if (queueingP99 < p99 - target) {
+				decision = "Overloaded";
+			} else if (interval > SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN) {
+				interval *= SERVER_KNOBS->COMMIT_BATCH_CONTROL_DECREASE_RATIO;
+				decision = "ShorterInterval";
+			} else if (countLimit > minCount) {
+				countLimit = std::max<int>(minCount, countLimit * SERVER_KNOBS->COMMIT_BATCH_CONTROL_DECREASE_RATIO);
+				decision = "SmallerBatches";
+			}
+		} else if (p99 < target * SERVER_KNOBS->COMMIT_BATCH_CONTROL_HEADROOM) {
+			if (countLimit < SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX) {
+				countLimit = std::min<int64_t>(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX, 2 * (int64_t)countLimit);
+				decision = "LargerBatches";
+			} else if (interval + SERVER_KNOBS->COMMIT_BATCH_CONTROL_INTERVAL_STEP <= budget) {
+				interval += SERVER_KNOBS->COMMIT_BATCH_CONTROL_INTERVAL_STEP;
+				decision = "LongerInterval";
+			}
+		}
+		interval = std::max(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
+		                    std::min({ SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX, interval, std::max(budget, 0.0) }));
+		return decision;
+	}
+};
+
 struct ProxyCommitData {
 	UID dbgid;
 	int64_t commitBatchesMemBytesCount;
@@ -255,6 +370,8 @@ struct ProxyCommitData {
 	bool locked;
 	Optional<Value> metadataVersion;
 	double commitBatchInterval;
+	int commitBatchCountLimit;
+	CommitBatchController batchController;
 
 	int64_t localCommitBatchesStarted;
 	NotifiedVersion latestLocalCommitBatchResolving;
@@ -344,7 +461,7 @@ struct ProxyCommitData {
 			committedVersion(recoveryTransactionVersion), version(0), minKnownCommittedVersion(0),
 			lastVersionTime(0), commitVersionRequestNumber(1), mostRecentProcessedRequestNumber(0),
 			getConsistentReadVersion(getConsistentReadVersion), commit(commit), lastCoalesceTime(0),
-			localCommitBatchesStarted(0), locked(false), commitBatchInterval(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN),
+			localCommitBatchesStarted(0), locked(false), commitBatchInterval(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN), commitBatchCountLimit(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX),
 			firstProxy(firstProxy), cx(openDBOnServer(db, TaskPriority::DefaultEndpoint, true, true)), db(db),
 			singleKeyMutationEvent(LiteralStringRef("SingleKeyMutation")), commitBatchesMemBytesCount(0), lastTxsPop(0), lastStartCommit(0), lastCommitLatency(SERVER_KNOBS->REQUIRED_MIN_RECOVERY_DURATION), lastCommitTime(0)
 	{
@@ -450,7 +567,7 @@ ACTOR Future<Void> commitBatcher(ProxyCommitData *commitData, PromiseStream<std:
 			timeout = delayJittered(SERVER_KNOBS->MAX_COMMIT_BATCH_INTERVAL, TaskPriority::ProxyCommitBatcher);
 		}
 
-		while(!timeout.isReady() && !(batch.size() == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX || batchBytes >= desiredBytes)) {
+		while(!timeout.isReady() && !(batch.size() >= commitData->commitBatchCountLimit || batchBytes >= desiredBytes)) {
 			choose{
 				when(CommitTransactionRequest req = waitNext(in)) {
 					int bytes = getBytes(req);
@@ -626,13 +743,16 @@ ACTOR Future<Void> commitBatch(
 	state int64_t localBatchNumber = ++self->localCommitBatchesStarted;
 	state LogPushData toCommit(self->logSystem);
 	state double t1 = now();
+	state CommitBatchPhaseTimes phaseTimes;
 	state Optional<UID> debugID;
 	state bool forceRecovery = false;
 	state int batchOperations = 0;
 	int64_t batchBytes = 0;
+	phaseTimes.start = phaseTimes.oldestRequest = g_network->timer();
 	for (int t = 0; t<trs.size(); t++) {
 		batchOperations += trs[t].transaction.mutations.size();
 		batchBytes += trs[t].transaction.mutations.expectedSize();
+		phaseTimes.oldestRequest = std::min(phaseTimes.oldestRequest, trs[t].requestTime());
 	}
 	state int latencyBucket = batchOperations == 0 ? 0 : std::min<int>(SERVER_KNOBS->PROXY_COMPUTE_BUCKETS-1,SERVER_KNOBS->PROXY_COMPUTE_BUCKETS*batchBytes/(batchOperations*(CLIENT_KNOBS->VALUE_SIZE_LIMIT+CLIENT_KNOBS->KEY_SIZE_LIMIT)));
 
@@ -721,6 +841,7 @@ ACTOR Future<Void> commitBatch(
 
 	/////// Phase 2: Resolution (waiting on the network; pipelined)
 	state vector<ResolveTransactionBatchReply> resolution = wait( getAll(replies) );
+	phaseTimes.resolved = g_network->timer();
 
 	if (debugID.present())
 		g_traceBatch.addEvent("CommitDebug", debugID.get().first(), "MasterProxyServer.commitBatch.AfterResolution");
@@ -1053,6 +1174,7 @@ ACTOR Future<Void> commitBatch(
 		debug_advanceMaxCommittedVersion(UID(), commitVersion);
 
 	state double commitStartTime = now();
+	phaseTimes.logStart = g_network->timer();
 	self->lastStartCommit = commitStartTime;
 	Future<Version> loggingComplete = self->logSystem->push( prevVersion, commitVersion, self->committedVersion.get(), self->minKnownCommittedVersion, toCommit, debugID );
 
@@ -1086,6 +1208,7 @@ ACTOR Future<Void> commitBatch(
 		}
 		throw;
 	}
+	phaseTimes.logged = g_network->timer();
 	self->lastCommitLatency = now()-commitStartTime;
 	self->lastCommitTime = std::max(self->lastCommitTime.get(), commitStartTime);
 	wait(yield(TaskPriority::ProxyCommitYield2));
@@ -1169,12 +1292,20 @@ ACTOR Future<Void> commitBatch(
 	}
 
 	// Dynamic batching for commits
-	double target_latency = (now() - t1) * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
-	self->commitBatchInterval = std::max(
-	    SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
-	    std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX,
-	             target_latency * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA +
-	                 self->commitBatchInterval * (1 - SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA)));
+	if (CommitBatchController::enabled()) {
+		phaseTimes.replied = endTime;
+		if (trs.size()) self->batchController.addBatch(phaseTimes, trs);
+		self->batchController.update(self->dbgid, g_network->timer());
+		self->commitBatchInterval = self->batchController.interval;
+		self->commitBatchCountLimit = self->batchController.countLimit;
+	} else {
+		double target_latency = (now() - t1) * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_LATENCY_FRACTION;
+		self->commitBatchInterval = std::max(
+		    SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN,
+		    std::min(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX,
+		             target_latency * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA +
+		                 self->commitBatchInterval * (1 - SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_SMOOTHER_ALPHA)));
+	}
 
 	self->commitBatchesMemBytesCount -= currentBatchMemBytesCount;
 	ASSERT_ABORT(self->commitBatchesMemBytesCount >= 0);
@@ -1921,3 +2052,57 @@ ACTOR Future<Void> masterProxyServer(
 	}
 	return Void();
 }
+
+TEST_CASE("/fdbserver/MasterProxy/CommitBatchController") {
+	CommitBatchController c;
+	if (!CommitBatchController::enabled()) c.target = 0.05;
+	double target = c.target;
+	c.countLimit = SERVER_KNOBS->COMMIT_BATCH_CONTROL_MIN_COUNT;
+
+	// Well under the target, batches grow to the maximum size and then the interval grows up to what the budget allows
+	double budget = SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX / 2;
+	for (int i = 0; i < 1000; i++) {
+		double interval = c.interval;
+		int countLimit = c.countLimit;
+		c.decide(0, budget, 0, 0);
+		ASSERT(c.interval >= interval && c.countLimit >= countLimit);
+		ASSERT(c.interval <= std::max(budget, SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN));
+	}
+	ASSERT(c.countLimit == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX);
+	ASSERT(c.interval + SERVER_KNOBS->COMMIT_BATCH_CONTROL_INTERVAL_STEP > budget);
+
+	// Between the headroom and the target nothing changes
+	double interval = c.interval;
+	ASSERT(std::string(c.decide(target * (1 + SERVER_KNOBS->COMMIT_BATCH_CONTROL_HEADROOM) / 2, budget, 0, 0)) == "Hold");
+	ASSERT(c.interval == interval && c.countLimit == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX);
+
+	// Over the target because the rest of the pipeline is slow, batches are left alone
+	ASSERT(std::string(c.decide(2 * target, budget, 0, 1e6)) == "Overloaded");
+	ASSERT(c.interval == interval && c.countLimit == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX);
+
+	// Over the target because of waiting in the batcher, the interval shrinks to the minimum first, and only then the
+	// batches, but never below what arrives in one interval
+	double transactionsPerSecond =
+	    1000 * SERVER_KNOBS->COMMIT_BATCH_CONTROL_MIN_COUNT / SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN;
+	int minCount = std::max<int64_t>(
+	    SERVER_KNOBS->COMMIT_BATCH_CONTROL_MIN_COUNT,
+	    std::min<double>(SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_COUNT_MAX,
+	                     std::ceil(transactionsPerSecond * SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN)));
+	for (int i = 0; i < 1000; i++) {
+		bool atMinimum = c.interval == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN;
+		int countLimit = c.countLimit;
+		c.decide(2 * target, budget, 2 * target, transactionsPerSecond);
+		ASSERT(atMinimum || c.countLimit == countLimit);
+	}
+	ASSERT(c.interval == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN);
+	ASSERT(c.countLimit == minCount);
+	for (int i = 0; i < 1000; i++) c.decide(2 * target, budget, 2 * target, 0);
+	ASSERT(c.countLimit == SERVER_KNOBS->COMMIT_BATCH_CONTROL_MIN_COUNT);
+
+	// A pipeline that uses up the whole target leaves no room to wait for more transactions
+	c.interval = SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MAX;
+	c.decide(0, -1, 0, 0);
+	ASSERT(c.interval == SERVER_KNOBS->COMMIT_TRANSACTION_BATCH_INTERVAL_MIN);
+
+	return Void();
+}
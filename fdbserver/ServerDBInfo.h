@@ -61,6 +61,81 @@ struct ServerDBInfo {
 	void serialize( Ar& ar ) {
 		serializer(ar, id, clusterInterface, client, distributor, master, ratekeeper, resolvers, recoveryCount, recoveryState, masterLifetime, logSystemConfig, priorCommittedLogServers, latencyBandConfig, storageCaches);
 	}
+
+	// The serialized members other than id, each encoded separately so that a ServerDBInfoUpdate can carry just the
+	// ones that changed.  Field numbers are only meaningful between processes running the same protocol version.
+	enum { FIELD_COUNT = 13 };
+
+	template <class Info, class F>
+	static void forEachField( Info& info, F f ) {
+		f(0, info.clusterInterface);
+		f(1, info.client);
+		f(2, info.distributor);
+		f(3, info.master);
+		f(4, info.ratekeeper);
+		f(5, info.resolvers);
+		f(6, info.recoveryCount);
+		f(7, info.recoveryState);
+		f(8, info.masterLifetime);
+		f(9, info.logSystemConfig);
+		f(10, info.priorCommittedLogServers);
+		f(11, info.latencyBandConfig);
+		f(12, info.storageCaches);
+	}
+
+	std::vector<Standalone<StringRef>> encodeFields() const {
+		std::vector<Standalone<StringRef>> fields(FIELD_COUNT);
+		forEachField(*this, [&fields](int i, auto const& field) {
+			fields[i] = BinaryWriter::toValue(field, AssumeVersion(currentProtocolVersion));
+		});
+		return fields;
+	}
+
+	void decodeField( int index, StringRef bytes ) {
+		forEachField(*this, [index, bytes](int i, auto& field) {
+			if(i == index) {
+				BinaryReader reader(bytes, AssumeVersion(currentProtocolVersion));
+				reader >> field;
+			}
+		});
+	}
+};
+
+// The reply to a GetServerDBInfoRequest.  If the requester's knownServerInfoID is still known to the cluster
+// controller, only the fields which have changed since then are sent; otherwise the whole ServerDBInfo is.
+struct ServerDBInfoUpdate {
+	constexpr static FileIdentifier file_identifier = 4215687;
+	UID id;
+	UID baseID;  // The ServerDBInfo the changed fields apply to, or UID() if the full ServerDBInfo is present
+	Optional<ServerDBInfo> full;
+	std::vector<int> changedFields;
+	std::vector<Standalone<StringRef>> fieldBytes;  // See ServerDBInfo::encodeFields()
+
+	ServerDBInfoUpdate() {}
+	explicit ServerDBInfoUpdate( ServerDBInfo const& info ) : id(info.id), full(info) {}
+
+	bool operator == (ServerDBInfoUpdate const& r) const { return id == r.id && baseID == r.baseID; }
+
+	// Returns false, leaving info unchanged, if this is a delta from a ServerDBInfo other than info
+	bool apply( ServerDBInfo& info ) const {
+		if(full.present()) {
+			info = full.get();
+			return true;
+		}
+		if(info.id != baseID) {
+			return false;
+		}
+		for(int i = 0; i < changedFields.size(); i++) {
+			info.decodeField(changedFields[i], fieldBytes[i]);
+		}
+		info.id = id;
+		return true;
+	}
+
+	template <class Ar>
+	void serialize( Ar& ar ) {
+		serializer(ar, id, baseID, full, changedFields, fieldBytes);
+	}
 };
 
 struct GetServerDBInfoRequest {
@@ -68,7 +143,7 @@ struct GetServerDBInfoRequest {
 	UID knownServerInfoID;
 	Standalone<VectorRef<StringRef>> issues;
 	std::vector<NetworkAddress> incompatiblePeers;
-	ReplyPromise< CachedSerialization<struct ServerDBInfo> > reply;
+	ReplyPromise< CachedSerialization<struct ServerDBInfoUpdate> > reply;
 
 	template <class Ar>
 	void serialize(Ar& ar) {
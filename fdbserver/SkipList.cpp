@@ -22,6 +22,7 @@
 #include <memory.h>
 #include <stdio.h>
 #include <algorithm>
+#include <deque>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -395,6 +396,19 @@ public:
 	}
 	void swap(SkipList& other) { std::swap(header, other.header); }
 
+	// Frees up to nodeCount nodes from the front of the list, so that a large list can be released a little at a time.
+	// Only level 0 is kept consistent, so the list may only be destroyed afterwards.  Returns true once it is empty.
+	bool destroySome(int nodeCount) {
+		Node* x = header->getNext(0);
+		while (x && nodeCount--) {
+			Node* next = x->getNext(0);
+			x->destroy();
+			x = next;
+		}
+		header->setNext(0, x);
+		return !x;
+	}
+
 	void addConflictRanges(const Finger* fingers, int rangeCount, Version version) {
 		for (int r = rangeCount - 1; r >= 0; r--) {
 			const Finger& startF = fingers[r * 2];
@@ -709,20 +723,67 @@ StringRef setK(Arena& arena, int i) {
 
 #include "fdbserver/ConflictSet.h"
 
+// The version history is split by version into generations, each a SkipList holding the write conflict ranges of
+// a span of versions.  New ranges only go into the newest generation, and each read conflict range is checked against
+// the generations that have a write newer than its snapshot.  Once every version in a generation is older than
+// oldestVersion the generation can't cause a conflict any more and is dropped whole, instead of being swept node by
+// node.  Its nodes are freed a batch at a time so that dropping a large generation doesn't stall the resolver.
+struct ConflictSetGeneration {
+	SkipList versionHistory;
+	Version firstVersion; // The oldest version written into this generation
+	Version newestVersion; // The newest version written into this generation
+
+	explicit ConflictSetGeneration(Version v, Version header = 0)
+	  : versionHistory(header), firstVersion(v), newestVersion(header) {}
+	ConflictSetGeneration(ConflictSetGeneration&& r) BOOST_NOEXCEPT : versionHistory(std::move(r.versionHistory)),
+	                                                                 firstVersion(r.firstVersion),
+	                                                                 newestVersion(r.newestVersion) {}
+	void operator=(ConflictSetGeneration&& r) BOOST_NOEXCEPT {
+		versionHistory = std::move(r.versionHistory);
+		firstVersion = r.firstVersion;
+		newestVersion = r.newestVersion;
+	}
+};
+
 struct ConflictSet {
-	ConflictSet() : oldestVersion(0) {}
+	ConflictSet() : oldestVersion(0) { generations.emplace_back(0); }
 	~ConflictSet() {}
 
-	SkipList versionHistory;
-	Key removalKey;
+	std::deque<ConflictSetGeneration> generations; // Oldest first; never empty
+	std::deque<SkipList> retired; // Dropped generations whose nodes are still being freed
 	Version oldestVersion;
+
+	// Returns the generation new writes at version now go into, starting a new one if the newest generation spans
+	// enough of the versions that are still being checked
+	SkipList& currentGeneration(Version now) {
+		Version span = std::max<Version>(1, (now - oldestVersion) / SERVER_KNOBS->RESOLVER_CONFLICT_SET_GENERATIONS);
+		if (now - generations.back().firstVersion >= span) generations.emplace_back(now);
+		generations.back().newestVersion = now;
+		return generations.back().versionHistory;
+	}
+
+	void dropGenerationsBefore(Version v, int nodeBudget) {
+		while (generations.size() > 1 && generations.front().newestVersion < v) {
+			retired.push_back(std::move(generations.front().versionHistory));
+			generations.pop_front();
+		}
+		while (retired.size() && retired.front().destroySome(nodeBudget)) retired.pop_front();
+	}
+
+	int count() {
+		int count = 0;
+		for (auto& g : generations) count += g.versionHistory.count();
+		return count;
+	}
 };
 
 ConflictSet* newConflictSet() {
 	return new ConflictSet;
 }
 void clearConflictSet(ConflictSet* cs, Version v) {
-	SkipList(v).swap(cs->versionHistory);
+	for (auto& g : cs->generations) cs->retired.push_back(std::move(g.versionHistory));
+	cs->generations.clear();
+	cs->generations.emplace_back(v, v);
 }
 void destroyConflictSet(ConflictSet* cs) {
 	delete cs;
@@ -847,20 +908,34 @@ void ConflictBatch::detectConflicts(Version now, Version newOldestVersion, std::
 	t = timer();
 	if (newOldestVersion > cs->oldestVersion) {
 		cs->oldestVersion = newOldestVersion;
-		SkipList::Finger finger;
-		int temp;
-		cs->versionHistory.find(&cs->removalKey, &finger, &temp, 1);
-		cs->versionHistory.removeBefore(cs->oldestVersion, finger, combinedWriteConflictRanges.size() * 3 + 10);
-		cs->removalKey = finger.getValue();
 	}
+	cs->dropGenerationsBefore(cs->oldestVersion, combinedWriteConflictRanges.size() * 3 + 10);
 	g_removeBefore += timer() - t;
 }
 
 void ConflictBatch::checkReadConflictRanges() {
 	if (!combinedReadConflictRanges.size()) return;
 
-	cs->versionHistory.detectConflicts(&combinedReadConflictRanges[0], combinedReadConflictRanges.size(),
-	                                   transactionConflictStatus);
+	Version oldestSnapshot = combinedReadConflictRanges[0].version;
+	for (auto& r : combinedReadConflictRanges) oldestSnapshot = std::min(oldestSnapshot, r.version);
+
+	Version newestSnapshot = oldestSnapshot;
+	for (auto& r : combinedReadConflictRanges) newestSnapshot = std::max(newestSnapshot, r.version);
+
+	std::vector<ReadConflictRange> olderRanges;
+	for (auto& g : cs->generations) {
+		if (g.newestVersion <= oldestSnapshot) continue; // Nothing in this generation is newer than any read
+		if (g.newestVersion > newestSnapshot) {
+			g.versionHistory.detectConflicts(&combinedReadConflictRanges[0], combinedReadConflictRanges.size(),
+			                                 transactionConflictStatus);
+		} else {
+			// Only the reads from before the generation's newest write can conflict with it
+			olderRanges.clear();
+			for (auto& r : combinedReadConflictRanges)
+				if (r.version < g.newestVersion) olderRanges.push_back(r);
+			g.versionHistory.detectConflicts(&olderRanges[0], olderRanges.size(), transactionConflictStatus);
+		}
+	}
 }
 
 void ConflictBatch::addConflictRanges(Version now, std::vector<std::pair<StringRef, StringRef>>::iterator begin,
@@ -887,7 +962,8 @@ void ConflictBatch::addConflictRanges(Version now, std::vector<std::pair<StringR
 void ConflictBatch::mergeWriteConflictRanges(Version now) {
 	if (!combinedWriteConflictRanges.size()) return;
 
-	addConflictRanges(now, combinedWriteConflictRanges.begin(), combinedWriteConflictRanges.end(), &cs->versionHistory);
+	addConflictRanges(now, combinedWriteConflictRanges.begin(), combinedWriteConflictRanges.end(),
+	                  &cs->currentGeneration(now));
 }
 
 void ConflictBatch::combineWriteConflictRanges() {
@@ -897,7 +973,10 @@ void ConflictBatch::combineWriteConflictRanges() {
 		if (point.write && !transactionConflictStatus[point.transaction]) {
 			if (point.begin) {
 				activeWriteCount++;
-				if (activeWriteCount == 1) combinedWriteConflictRanges.emplace_back(point.key, KeyRef());
+				// A range that starts where the previous one ended is merged into it, since both get the same version
+				if (activeWriteCount == 1 && (combinedWriteConflictRanges.empty() ||
+				                              combinedWriteConflictRanges.back().second != point.key))
+					combinedWriteConflictRanges.emplace_back(point.key, KeyRef());
 			} else /*if (point.end)*/ {
 				activeWriteCount--;
 				if (activeWriteCount == 0) combinedWriteConflictRanges.back().second = point.key;
@@ -1046,5 +1125,5 @@ void skipListTest() {
 		printf("%20s: %s\n", skc[c]->getMetric().name().c_str(), skc[c]->getMetric().formatted().c_str());
 	}
 
-	printf("%d entries in version history\n", cs->versionHistory.count());
+	printf("%d entries in version history (%d generations)\n", cs->count(), (int)cs->generations.size());
 }
@@ -21,6 +21,7 @@
 #include <cinttypes>
 #include "fdbserver/Status.h"
 #include "flow/Trace.h"
+#include "flow/Histogram.h"
 #include "fdbclient/NativeAPI.actor.h"
 #include "fdbclient/SystemData.h"
 #include "fdbclient/ReadYourWrites.h"
@@ -162,6 +163,51 @@ static Future< Optional< std::pair<WorkerEvents, std::set<std::string>> > > late
 	return latestEventOnWorkers( workers, "" );
 }
 
+// Like latestEventOnWorkers, but only polls the workers whose event in the cache is older than ttl
+ACTOR static Future< Optional< std::pair<WorkerEvents, std::set<std::string>> > > cachedLatestEventOnWorkers(Reference<StatusEventCache> cache, std::vector<WorkerDetails> workers, std::string eventName, double ttl) {
+	state WorkerEvents results;
+	state std::vector<WorkerDetails> stale;
+
+	// Expired events are dropped so that workers which have gone away do not stay in the cache
+	auto& events = cache->events;
+	for(auto it = events.lower_bound(std::make_pair(eventName, UID())); it != events.end() && it->first.first == eventName;) {
+		if(now() - it->second.first >= ttl) {
+			it = events.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	for(auto const& worker : workers) {
+		auto it = events.find(std::make_pair(eventName, worker.interf.id()));
+		if(it != events.end()) {
+			results[worker.interf.address()] = it->second.second;
+		} else {
+			stale.push_back(worker);
+		}
+	}
+
+	state std::pair<WorkerEvents, std::set<std::string>> val;
+	if(!stale.empty()) {
+		Optional< std::pair<WorkerEvents, std::set<std::string>> > fetched = wait(latestEventOnWorkers(stale, eventName));
+		if(!fetched.present()) {
+			return fetched;
+		}
+		for(auto const& worker : stale) {
+			auto event = fetched.get().first.find(worker.interf.address());
+			if(event == fetched.get().first.end()) continue;
+			if(!fetched.get().second.count(event->first.toString())) {
+				cache->events[std::make_pair(eventName, worker.interf.id())] = std::make_pair(now(), event->second);
+			}
+			results[event->first] = event->second;
+		}
+		val.second = fetched.get().second;
+	}
+
+	val.first = results;
+	return val;
+}
+
 static Optional<WorkerDetails> getWorker(std::vector<WorkerDetails> const& workers, NetworkAddress const& address) {
 	try {
 		for (int c = 0; c < workers.size(); c++)
@@ -885,6 +931,37 @@ struct ClientStats {
 	ClientStats() : count(0) {}
 };
 
+// Merges the per-process request latency histograms into cluster wide percentiles and buckets for each request type
+static JsonBuilderArray requestLatencyStatusFetcher(WorkerEvents const& latencyHistograms) {
+	std::map<std::string, LatencyHistogram> merged;
+	for (auto const& worker : latencyHistograms) {
+		for (auto const& field : worker.second) {
+			std::string prefix = LatencyHistogram::METRICS_DETAIL_PREFIX;
+			if (field.first.compare(0, prefix.size(), prefix) != 0) continue;
+			LatencyHistogram h;
+			if (!h.mergeEncoded(field.second)) {
+				TraceEvent(SevWarn, "StatusBadLatencyHistogram").detail("Worker", worker.first).detail("Name", field.first);
+			} else if (h.count()) {
+				merged[field.first.substr(prefix.size())].merge(h);
+			}
+		}
+	}
+
+	JsonBuilderArray latencies;
+	for (auto const& it : merged) {
+		JsonBuilderObject latency;
+		latency["request_type"] = it.first;
+		latency["count"] = (int64_t)it.second.count();
+		latency["p50_seconds"] = it.second.percentile(0.5);
+		latency["p99_seconds"] = it.second.percentile(0.99);
+		latency["p999_seconds"] = it.second.percentile(0.999);
+		// The raw buckets, so that consumers can merge intervals or clusters and compute their own percentiles
+		latency["buckets"] = it.second.encode();
+		latencies.push_back(latency);
+	}
+	return latencies;
+}
+
 static JsonBuilderObject clientStatusFetcher(std::map<NetworkAddress, std::pair<double, OpenDatabaseRequest>>* clientStatusMap) {
 	JsonBuilderObject clientStatus;
 
@@ -2139,7 +2216,8 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		std::map<NetworkAddress, std::pair<double, OpenDatabaseRequest>>* clientStatus,
 		ServerCoordinators coordinators,
 		std::vector<NetworkAddress> incompatibleConnections,
-		Version datacenterVersionDifference )
+		Version datacenterVersionDifference,
+		Reference<StatusEventCache> eventCache )
 {
 	state double tStart = timer();
 
@@ -2186,12 +2264,13 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		// WorkerEvents is a map of worker's NetworkAddress to its event string
 		// The pair represents worker responses and a set of worker NetworkAddress strings which did not respond
 		std::vector< Future< Optional <std::pair<WorkerEvents, std::set<std::string>>> > > futures;
-		futures.push_back(latestEventOnWorkers(workers, "MachineMetrics"));
-		futures.push_back(latestEventOnWorkers(workers, "ProcessMetrics"));
-		futures.push_back(latestEventOnWorkers(workers, "NetworkMetrics"));
-		futures.push_back(latestErrorOnWorkers(workers));
-		futures.push_back(latestEventOnWorkers(workers, "TraceFileOpenError"));
-		futures.push_back(latestEventOnWorkers(workers, "ProgramStart"));
+		futures.push_back(cachedLatestEventOnWorkers(eventCache, workers, "MachineMetrics", SERVER_KNOBS->STATUS_METRICS_EVENT_TTL));
+		futures.push_back(cachedLatestEventOnWorkers(eventCache, workers, "ProcessMetrics", SERVER_KNOBS->STATUS_METRICS_EVENT_TTL));
+		futures.push_back(cachedLatestEventOnWorkers(eventCache, workers, "NetworkMetrics", SERVER_KNOBS->STATUS_METRICS_EVENT_TTL));
+		futures.push_back(cachedLatestEventOnWorkers(eventCache, workers, "", SERVER_KNOBS->STATUS_METRICS_EVENT_TTL)); // The latest error
+		futures.push_back(cachedLatestEventOnWorkers(eventCache, workers, "TraceFileOpenError", SERVER_KNOBS->STATUS_STATIC_EVENT_TTL));
+		futures.push_back(cachedLatestEventOnWorkers(eventCache, workers, "ProgramStart", SERVER_KNOBS->STATUS_STATIC_EVENT_TTL));
+		futures.push_back(cachedLatestEventOnWorkers(eventCache, workers, "LatencyHistogramMetrics", SERVER_KNOBS->STATUS_METRICS_EVENT_TTL));
 
 		// Wait for all response pairs.
 		state std::vector< Optional <std::pair<WorkerEvents, std::set<std::string>>> > workerEventsVec = wait(getAll(futures));
@@ -2232,6 +2311,7 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		state WorkerEvents latestError = workerEventsVec[3].present() ? workerEventsVec[3].get().first : WorkerEvents();
 		state WorkerEvents traceFileOpenErrors = workerEventsVec[4].present() ? workerEventsVec[4].get().first : WorkerEvents();
 		state WorkerEvents programStarts = workerEventsVec[5].present() ? workerEventsVec[5].get().first : WorkerEvents();
+		state WorkerEvents latencyHistograms = workerEventsVec[6].present() ? workerEventsVec[6].get().first : WorkerEvents();
 
 		state JsonBuilderObject statusObj;
 		if(db->get().read().recoveryCount > 0) {
@@ -2406,6 +2486,7 @@ ACTOR Future<StatusReply> clusterGetStatus(
 		                                                            &status_incomplete_reasons));
 		statusObj["processes"] = processStatus;
 		statusObj["clients"] = clientStatusFetcher(clientStatus);
+		statusObj["request_latencies"] = requestLatencyStatusFetcher(latencyHistograms);
 
 		JsonBuilderArray incompatibleConnectionsArray;
 		for(auto it : incompatibleConnections) {
@@ -34,7 +34,15 @@ void setIssues(ProcessIssuesMap& issueMap, NetworkAddress const& addr, VectorRef
 
 void removeIssues(ProcessIssuesMap& issueMap, NetworkAddress const& addr, Optional<UID>& issueID);
 
+// The latest trace events fetched from each worker for status, keyed by event name and worker address.  An event is
+// reused until it is older than the TTL for its type, so that frequent status requests do not each poll every worker.
+struct StatusEventCache : ReferenceCounted<StatusEventCache> {
+	// Keyed by event name and worker interface id, so that a process restarted at the same address is polled again
+	std::map<std::pair<std::string, UID>, std::pair<double, TraceEventFields>> events;
+};
+
 Future<StatusReply> clusterGetStatus( Reference<AsyncVar<CachedSerialization<struct ServerDBInfo>>> const& db, Database const& cx, vector<WorkerDetails> const& workers,
-	ProcessIssuesMap const& workerIssues, std::map<NetworkAddress, std::pair<double, OpenDatabaseRequest>>* const& clientStatus, ServerCoordinators const& coordinators, std::vector<NetworkAddress> const& incompatibleConnections, Version const& datacenterVersionDifference );
+	ProcessIssuesMap const& workerIssues, std::map<NetworkAddress, std::pair<double, OpenDatabaseRequest>>* const& clientStatus, ServerCoordinators const& coordinators, std::vector<NetworkAddress> const& incompatibleConnections, Version const& datacenterVersionDifference,
+	Reference<StatusEventCache> const& eventCache );
 
 #endif
@@ -48,7 +48,7 @@ inline bool canReplyWith(Error e) {
 	};
 }
 
-const int VERSION_OVERHEAD = 64 + sizeof(Version) + sizeof(Standalone<VersionUpdateRef>) + //mutationLog, 64b overhead for map
+const int VERSION_OVERHEAD = sizeof(Standalone<VersionUpdateRef>) + //mutationLog
 	2 * (64 + sizeof(Version) + sizeof(Reference<VersionedMap<KeyRef,
 									   ValueOrClearToRef>::PTreeT>)); //versioned map [ x2 for createNewVersion(version+1) ], 64b overhead for map
 static int mvccStorageBytes( MutationRef const& m ) { return VersionedMap<KeyRef, ValueOrClearToRef>::overheadPerItem * 2 + (MutationRef::OVERHEAD_BYTES + m.param1.size() + m.param2.size()) * 2; }
@@ -58,9 +58,11 @@ struct StorageCacheData {
 private:
 	// in-memory versioned struct (PTree as of now. Subject to change)
 	VersionedData versionedData;
-	// in-memory mutationLog that the versionedData contains references to
-	// TODO change it to a deque, already contains mutations in version order
-	std::map<Version, Standalone<VersionUpdateRef>> mutationLog; // versions (durableVersion, version]
+	// in-memory mutationLog, in version order
+	Deque<Standalone<VersionUpdateRef>> mutationLog; // versions [oldestVersion, version]
+	// The arenas of the mutationLog, which the versionedData contains references to.  Nothing is ever made durable,
+	// and nodes copied by later updates keep pointing into old arenas, so they outlive the popped versions.
+	Deque<Arena> mutationArenas;
 
 public:
 	UID thisServerID; // unique id
@@ -147,26 +149,38 @@ public:
 	}
 
 	Arena lastArena;
-	std::map<Version, Standalone<VersionUpdateRef>> const & getMutationLog() { return mutationLog; }
-	std::map<Version, Standalone<VersionUpdateRef>>& getMutableMutationLog() { return mutationLog; }
+	Deque<Standalone<VersionUpdateRef>> const & getMutationLog() { return mutationLog; }
+	Deque<Standalone<VersionUpdateRef>>& getMutableMutationLog() { return mutationLog; }
 	VersionedData const& data() const { return versionedData; }
 	VersionedData& mutableData() { return versionedData; }
 
+	// The returned reference is invalidated by adding the next version
 	Standalone<VersionUpdateRef>& addVersionToMutationLog(Version v) {
 		// return existing version...
-		auto m = mutationLog.find(v);
-		if (m != mutationLog.end())
-			return m->second;
+		if (!mutationLog.empty() && mutationLog.back().version == v)
+			return mutationLog.back();
 
-		// ...or create a new one
-		auto& u = mutationLog[v];
+		// ...or create a new one. Versions are added in order, so it always goes at the end
+		ASSERT(mutationLog.empty() || mutationLog.back().version < v);
+		auto& u = mutationLog.emplace_back();
 		u.version = v;
-		if (lastArena.getSize() >= 65536) lastArena = Arena(4096);
+		if (!lastArena.getSize() || lastArena.getSize() >= 65536) {
+			lastArena = Arena(4096);
+			mutationArenas.push_back(lastArena);
+		}
 		u.arena() = lastArena;
 		counters.bytesInput += VERSION_OVERHEAD;
 		return u;
 	}
 
+	// Versions before oldestVersion can no longer be read, so their entries are dropped.  The mutations themselves
+	// stay in mutationArenas.
+	void popMutationLog(Version oldestVersion) {
+		while (!mutationLog.empty() && mutationLog.front().version < oldestVersion) {
+			mutationLog.pop_front();
+		}
+	}
+
 	MutationRef addMutationToMutationLog(Standalone<VersionUpdateRef> &mLV, MutationRef const& m){
 		//TODO find out more
 		//byteSampleApplyMutation(m, mLV.version);
@@ -291,7 +305,7 @@ ACTOR Future<Void> getValueQ( StorageCacheData* data, GetValueRequest req ) {
 	//--data->readQueueSizeMetric;
 	//if(data->latencyBandConfig.present()) {
 	//	int maxReadBytes = data->latencyBandConfig.get().readConfig.maxReadBytes.orDefault(std::numeric_limits<int>::max());
-	//	data->counters.readLatencyBands.addMeasurement(timer() - req.requestTime(), resultSize > maxReadBytes);
+	//	data->counters.readLatencyBands.addMeasurement(g_network->timer() - req.requestTime(), resultSize > maxReadBytes);
 	//}
 
 	return Void();
@@ -789,8 +803,9 @@ private:
 	}
 };
 
-// Compacts the in-memory VersionedMap, i.e. removes versions below the desiredOldestVersion
-// TODO revisit if we change the data structure
+// Compacts the in-memory VersionedMap, i.e. removes versions below the desiredOldestVersion.
+// Unlike a storage server the cache never makes data durable, so without compaction the replaced children of
+// every updated PTree node would be kept forever.
 ACTOR Future<Void> compactCache(StorageCacheData* data) {
 	loop {
 		//TODO understand this, should we add delay here?
@@ -809,21 +824,23 @@ ACTOR Future<Void> compactCache(StorageCacheData* data) {
 		state Promise<Void> compactionInProgress;
 		data->compactionInProgress = compactionInProgress.getFuture();
 		state Version desiredVersion = data->desiredOldestVersion.get();
-		// Call the compaction routine that does the actual work,
-		// TODO It's a synchronous function call as of now. Should it asynch?
-		data->mutableData().compact(desiredVersion);
+		// Forget the old versions before compacting, since compaction changes what reads at those versions would see
 		Future<Void> finishedForgetting = data->mutableData().forgetVersionsBeforeAsync( desiredVersion,
 																						 TaskPriority::CompactCache );
 		data->oldestVersion.set( desiredVersion );
+		data->popMutationLog( desiredVersion );
 		wait( finishedForgetting );
-		// TODO how do we yield here? This may not be enough, because compact() does the heavy lifting
-		// of compating the VersionedMap. We should probably look into per version compaction and then
-		// we can yield after compacting one version
+		// The walk yields, so the cache keeps applying mutations and serving reads while a large map is compacted
+		wait( data->mutableData().compactAsync( SERVER_KNOBS->STORAGE_CACHE_COMPACTION_NODES_PER_YIELD,
+		                                        TaskPriority::CompactCache ) );
 		wait( yield(TaskPriority::CompactCache) );
 
 		// TODO what flowlock to acquire during compaction?
 		compactionInProgress.send(Void());
 		wait( delay(0, TaskPriority::CompactCache) ); //Setting compactionInProgess could cause the cache server to shut down, so delay to check for cancellation
+
+		// Each compaction walks the whole map, so batch the versions of an interval into one walk
+		wait( delay(SERVER_KNOBS->STORAGE_CACHE_COMPACTION_INTERVAL, TaskPriority::CompactCache) );
 	}
 }
 
@@ -679,7 +679,9 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 		return Reference<ILogSystem::BufferedCursor>( new ILogSystem::BufferedCursor(cursors, begin, end.present() ? end.get() + 1 : getPeekEnd(), true, tLogs[0]->locality == tagLocalityUpgraded, false) );
 	}
 
-	Reference<IPeekCursor> peekLocal( UID dbgid, Tag tag, Version begin, Version end, bool useMergePeekCursors, int8_t peekLocality = tagLocalityInvalid ) {
+	// parallelGetMore is for storage servers, whose outstanding peeks are bounded by STORAGE_SERVER_PARALLEL_PEEK_BYTES
+	Reference<IPeekCursor> peekLocal( UID dbgid, Tag tag, Version begin, Version end, bool useMergePeekCursors, int8_t peekLocality = tagLocalityInvalid, bool parallelGetMore = false ) {
+		int maxGetMoreWindow = parallelGetMore ? std::max<int64_t>( 1, SERVER_KNOBS->STORAGE_SERVER_PARALLEL_PEEK_BYTES / SERVER_KNOBS->DESIRED_TOTAL_BYTES ) : 0;
 		if(tag.locality >= 0 || tag.locality == tagLocalityUpgraded) {
 			peekLocality = tag.locality;
 		}
@@ -715,7 +717,7 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 				return Reference<ILogSystem::MergedPeekCursor>( new ILogSystem::MergedPeekCursor( tLogs[bestSet]->logServers, tLogs[bestSet]->bestLocationFor( tag ), tLogs[bestSet]->logServers.size() + 1 - tLogs[bestSet]->tLogReplicationFactor, tag,
 							begin, end, true, tLogs[bestSet]->tLogLocalities, tLogs[bestSet]->tLogPolicy, tLogs[bestSet]->tLogReplicationFactor) );
 			} else {
-				return Reference<ILogSystem::ServerPeekCursor>( new ILogSystem::ServerPeekCursor( tLogs[bestSet]->logServers[tLogs[bestSet]->bestLocationFor( tag )], tag, begin, end, false, false ) );
+				return Reference<ILogSystem::ServerPeekCursor>( new ILogSystem::ServerPeekCursor( tLogs[bestSet]->logServers[tLogs[bestSet]->bestLocationFor( tag )], tag, begin, end, false, parallelGetMore, maxGetMoreWindow ) );
 			}
 		} else {
 			std::vector< Reference<ILogSystem::IPeekCursor> > cursors;
@@ -727,7 +729,7 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 					cursors.emplace_back(new ILogSystem::MergedPeekCursor(tLogs[bestSet]->logServers, tLogs[bestSet]->bestLocationFor( tag ), tLogs[bestSet]->logServers.size() + 1 - tLogs[bestSet]->tLogReplicationFactor, tag,
 								tLogs[bestSet]->startVersion, end, true, tLogs[bestSet]->tLogLocalities, tLogs[bestSet]->tLogPolicy, tLogs[bestSet]->tLogReplicationFactor));
 				} else {
-					cursors.emplace_back(new ILogSystem::ServerPeekCursor( tLogs[bestSet]->logServers[tLogs[bestSet]->bestLocationFor( tag )], tag, tLogs[bestSet]->startVersion, end, false, false));
+					cursors.emplace_back(new ILogSystem::ServerPeekCursor( tLogs[bestSet]->logServers[tLogs[bestSet]->bestLocationFor( tag )], tag, tLogs[bestSet]->startVersion, end, false, parallelGetMore, maxGetMoreWindow));
 				}
 			}
 			Version lastBegin = tLogs[bestSet]->startVersion;
@@ -876,13 +878,13 @@ struct TagPartitionedLogSystem : ILogSystem, ReferenceCounted<TagPartitionedLogS
 
 		if(history.size() == 0) {
 			TraceEvent("TLogPeekSingleNoHistory", dbgid).detail("Tag", tag.toString()).detail("Begin", begin);
-			return peekLocal(dbgid, tag, begin, getPeekEnd(), false);
+			return peekLocal(dbgid, tag, begin, getPeekEnd(), false, tagLocalityInvalid, SERVER_KNOBS->STORAGE_SERVER_PARALLEL_PEEKS);
 		} else {
 			std::vector< Reference<ILogSystem::IPeekCursor> > cursors;
 			std::vector< LogMessageVersion > epochEnds;
 
 			TraceEvent("TLogPeekSingleAddingLocal", dbgid).detail("Tag", tag.toString()).detail("Begin", history[0].first);
-			cursors.push_back( peekLocal(dbgid, tag, history[0].first, getPeekEnd(), false) );
+			cursors.push_back( peekLocal(dbgid, tag, history[0].first, getPeekEnd(), false, tagLocalityInvalid, SERVER_KNOBS->STORAGE_SERVER_PARALLEL_PEEKS) );
 
 			for(int i = 0; i < history.size(); i++) {
 				TraceEvent("TLogPeekSingleAddingOld", dbgid).detail("Tag", tag.toString()).detail("HistoryTag", history[i].second.toString()).detail("Begin", i+1 == history.size() ? begin : std::max(history[i+1].first, begin)).detail("End", history[i].first);
@@ -28,6 +28,7 @@
 #include "fdbserver/IPager.h"
 #include "fdbrpc/IAsyncFile.h"
 #include "flow/crc32c.h"
+#include "fdbrpc/zlib/zlib.h"
 #include "flow/ActorCollection.h"
 #include <map>
 #include <vector>
@@ -2703,11 +2704,19 @@ public:
 	typedef FIFOQueue<LazyDeleteQueueEntry> LazyDeleteQueueT;
 
 #pragma pack(push, 1)
+	// How values are stored, chosen when the tree is created.  The tree itself stores whatever bytes it is given, it is
+	// up to its user to encode and decode them.
+	enum ValueEncoding : uint8_t {
+		RAW_VALUES = 0,
+		COMPRESSED_VALUES = 1 // See RedwoodValueCodec
+	};
+
 	struct MetaKey {
-		static constexpr int FORMAT_VERSION = 4;
+		static constexpr int FORMAT_VERSION = 5;
 		// This serves as the format version for the entire tree, individual pages will not be versioned
 		uint16_t formatVersion;
 		uint8_t height;
+		uint8_t valueEncoding;
 		LazyDeleteQueueT::QueueState lazyDeleteQueue;
 		InPlaceArray<LogicalPageID> root;
 
@@ -2716,12 +2725,26 @@ public:
 		}
 
 		void fromKeyRef(KeyRef k) {
-			memcpy(this, k.begin(), k.size());
+			uint16_t version;
+			ASSERT(k.size() >= sizeof(version));
+			memcpy(&version, k.begin(), sizeof(version));
+			if(version == 4) {
+				// Version 4 is the same but without valueEncoding, since its values were always raw.  The header is
+				// written in the current format at the next commit.
+				int prefix = sizeof(formatVersion) + sizeof(height);
+				memcpy(this, k.begin(), prefix);
+				memcpy((uint8_t *)this + prefix + sizeof(valueEncoding), k.begin() + prefix, k.size() - prefix);
+				formatVersion = FORMAT_VERSION;
+				valueEncoding = RAW_VALUES;
+			}
+			else {
+				memcpy(this, k.begin(), k.size());
+			}
 			ASSERT(formatVersion == FORMAT_VERSION);
 		}
 
 		std::string toString() {
-			return format("{height=%d  formatVersion=%d  root=%s  lazyDeleteQueue=%s}", (int)height, (int)formatVersion, ::toString(root.get()).c_str(), lazyDeleteQueue.toString().c_str());
+			return format("{height=%d  formatVersion=%d  valueEncoding=%d  root=%s  lazyDeleteQueue=%s}", (int)height, (int)formatVersion, (int)valueEncoding, ::toString(root.get()).c_str(), lazyDeleteQueue.toString().c_str());
 		}
 
 	};
@@ -2753,11 +2776,13 @@ public:
 		int64_t commitToPage;
 		int64_t commitToPageStart;
 		int64_t pageUpdates;
+		int64_t valueBytes; // Value bytes given to the KeyValueStore
+		int64_t encodedValueBytes; // The same values' bytes as stored in the tree
 		double startTime;
 
 		std::string toString(bool clearAfter = false) {
-			const char *labels[] = {"set", "clear", "clearSingleKey", "get", "getRange", "commit", "pageReads", "extPageRead", "pagePreloads", "extPagePreloads", "pageWrite", "extPageWrite", "commitPage", "commitPageStart", "pageUpdates"};
-			const int64_t values[] = {sets, clears, clearSingleKey, gets, getRanges, commits, pageReads, extPageReads, pagePreloads, extPagePreloads, pageWrites, extPageWrites, commitToPage, commitToPageStart, pageUpdates};
+			const char *labels[] = {"set", "clear", "clearSingleKey", "get", "getRange", "commit", "pageReads", "extPageRead", "pagePreloads", "extPagePreloads", "pageWrite", "extPageWrite", "commitPage", "commitPageStart", "pageUpdates", "valueBytes", "encodedValueBytes"};
+			const int64_t values[] = {sets, clears, clearSingleKey, gets, getRanges, commits, pageReads, extPageReads, pagePreloads, extPagePreloads, pageWrites, extPageWrites, commitToPage, commitToPageStart, pageUpdates, valueBytes, encodedValueBytes};
 
 			double elapsed = now() - startTime;
 			std::string s;
@@ -2862,6 +2887,11 @@ public:
 		return m_lastCommittedVersion;
 	}
 
+	// Valid once init() is ready
+	ValueEncoding getValueEncoding() const {
+		return (ValueEncoding)m_header.valueEncoding;
+	}
+
 	VersionedBTree(IPager2 *pager, std::string name)
 	  : m_pager(pager),
 		m_writeVersion(invalidVersion),
@@ -2959,6 +2989,7 @@ public:
 		state Key meta = self->m_pager->getMetaKey();
 		if(meta.size() == 0) {
 			self->m_header.formatVersion = MetaKey::FORMAT_VERSION;
+			self->m_header.valueEncoding = SERVER_KNOBS->REDWOOD_VALUE_COMPRESSION ? COMPRESSED_VALUES : RAW_VALUES;
 			LogicalPageID id = wait(self->m_pager->newPageID());
 			BTreePageID newRoot((LogicalPageID *)&id, 1);
 			debug_printf("new root %s\n", toString(newRoot).c_str());
@@ -5000,6 +5031,56 @@ RedwoodRecordRef VersionedBTree::dbBegin(StringRef(), 0);
 RedwoodRecordRef VersionedBTree::dbEnd(LiteralStringRef("\xff\xff\xff\xff\xff"));
 VersionedBTree::Counts VersionedBTree::counts;
 
+// Encodes the values of a Redwood tree created with COMPRESSED_VALUES.  Each value starts with a tag byte: a RAW value
+// is followed by its bytes, and a ZLIB value by its length as a 32 bit little endian integer and then the zlib stream.
+// Values are only stored compressed if they are at least REDWOOD_VALUE_COMPRESSION_MIN_BYTES long and compression
+// makes them smaller.  Smaller values mean more records per page, so both the file and the pages in the pager's cache
+// hold more of the data.
+struct RedwoodValueCodec {
+	enum Tag : uint8_t { RAW = 0, ZLIB = 1 };
+	static constexpr int ZLIB_HEADER_BYTES = 1 + sizeof(uint32_t);
+
+	static ValueRef encode(Arena& arena, ValueRef value) {
+		if(value.size() >= SERVER_KNOBS->REDWOOD_VALUE_COMPRESSION_MIN_BYTES && value.size() > ZLIB_HEADER_BYTES) {
+			uLongf compressedBytes = compressBound(value.size());
+			uint8_t *buf = new (arena) uint8_t[ZLIB_HEADER_BYTES + compressedBytes];
+			if(compress2(buf + ZLIB_HEADER_BYTES, &compressedBytes, value.begin(), value.size(), SERVER_KNOBS->REDWOOD_VALUE_COMPRESSION_LEVEL) == Z_OK
+				&& ZLIB_HEADER_BYTES + compressedBytes < 1 + value.size()
+			) {
+				buf[0] = ZLIB;
+				uint32_t size = value.size();
+				memcpy(buf + 1, &size, sizeof(size));
+				return ValueRef(buf, ZLIB_HEADER_BYTES + compressedBytes);
+			}
+		}
+
+		uint8_t *buf = new (arena) uint8_t[1 + value.size()];
+		buf[0] = RAW;
+		memcpy(buf + 1, value.begin(), value.size());
+		return ValueRef(buf, 1 + value.size());
+	}
+
+	// Decodes up to maxLength bytes of the value
+	static ValueRef decode(Arena& arena, ValueRef encoded, int maxLength = std::numeric_limits<int>::max()) {
+		ASSERT(encoded.size() >= 1);
+		if(encoded[0] == RAW) {
+			encoded = encoded.substr(1);
+			return ValueRef(arena, encoded.substr(0, std::min(maxLength, encoded.size())));
+		}
+
+		ASSERT(encoded[0] == ZLIB && encoded.size() >= ZLIB_HEADER_BYTES);
+		uint32_t size;
+		memcpy(&size, encoded.begin() + 1, sizeof(size));
+		uint8_t *buf = new (arena) uint8_t[size];
+		uLongf decodedBytes = size;
+		if(uncompress(buf, &decodedBytes, encoded.begin() + ZLIB_HEADER_BYTES, encoded.size() - ZLIB_HEADER_BYTES) != Z_OK || decodedBytes != size) {
+			TraceEvent(SevError, "RedwoodValueDecodeFailed").detail("EncodedBytes", encoded.size()).detail("Bytes", size);
+			throw checksum_failed();
+		}
+		return ValueRef(buf, std::min<int>(maxLength, size));
+	}
+};
+
 class KeyValueStoreRedwoodUnversioned : public IKeyValueStore {
 public:
 	KeyValueStoreRedwoodUnversioned(std::string filePrefix, UID logID) : m_filePrefix(filePrefix) {
@@ -5077,7 +5158,25 @@ public:
 
     void set( KeyValueRef keyValue, const Arena* arena = NULL ) {
 		debug_printf("SET %s\n", printable(keyValue).c_str());
-		m_tree->set(keyValue);
+		if(m_tree->getValueEncoding() == VersionedBTree::COMPRESSED_VALUES) {
+			Arena encodeArena;
+			ValueRef encoded = RedwoodValueCodec::encode(encodeArena, keyValue.value);
+			m_tree->counts.valueBytes += keyValue.value.size();
+			m_tree->counts.encodedValueBytes += encoded.size();
+			m_tree->set(KeyValueRef(keyValue.key, encoded));
+		}
+		else {
+			m_tree->set(keyValue);
+		}
+	}
+
+	// Copies the value under the cursor into arena, decoding it if necessary
+	ValueRef getValue(Arena &arena, Reference<IStoreCursor> const &cur, int maxLength = std::numeric_limits<int>::max()) {
+		if(m_tree->getValueEncoding() == VersionedBTree::COMPRESSED_VALUES) {
+			return RedwoodValueCodec::decode(arena, cur->getValue(), maxLength);
+		}
+		ValueRef v = cur->getValue();
+		return ValueRef(arena, v.substr(0, std::min(maxLength, v.size())));
 	}
 
 	Future< Standalone< RangeResultRef > > readRange(KeyRangeRef keys, int rowLimit = 1<<30, int byteLimit = 1<<30) {
@@ -5102,7 +5201,7 @@ public:
 		if(rowLimit > 0) {
 			wait(cur->findFirstEqualOrGreater(keys.begin, prefetchBytes));
 			while(cur->isValid() && cur->getKey() < keys.end) {
-				KeyValueRef kv(KeyRef(result.arena(), cur->getKey()), ValueRef(result.arena(), cur->getValue()));
+				KeyValueRef kv(KeyRef(result.arena(), cur->getKey()), self->getValue(result.arena(), cur));
 				accumulatedBytes += kv.expectedSize();
 				result.push_back(result.arena(), kv);
 				if(--rowLimit == 0 || accumulatedBytes >= byteLimit) {
@@ -5116,7 +5215,7 @@ public:
 				wait(cur->prev());
 
 			while(cur->isValid() && cur->getKey() >= keys.begin) {
-				KeyValueRef kv(KeyRef(result.arena(), cur->getKey()), ValueRef(result.arena(), cur->getValue()));
+				KeyValueRef kv(KeyRef(result.arena(), cur->getKey()), self->getValue(result.arena(), cur));
 				accumulatedBytes += kv.expectedSize();
 				result.push_back(result.arena(), kv);
 				if(++rowLimit == 0 || accumulatedBytes >= byteLimit) {
@@ -5140,7 +5239,9 @@ public:
 
 		wait(cur->findEqual(key));
 		if(cur->isValid()) {
-			return cur->getValue();
+			Value v;
+			v.contents() = self->getValue(v.arena(), cur);
+			return v;
 		}
 		return Optional<Value>();
 	}
@@ -5155,9 +5256,9 @@ public:
 
 		wait(cur->findEqual(key));
 		if(cur->isValid()) {
-			Value v = cur->getValue();
-			int len = std::min(v.size(), maxLength);
-			return Value(cur->getValue().substr(0, len));
+			Value v;
+			v.contents() = self->getValue(v.arena(), cur, maxLength);
+			return v;
 		}
 		return Optional<Value>();
 	}
@@ -5838,6 +5939,67 @@ TEST_CASE("!/redwood/correctness/unit/RedwoodRecordRef") {
 	return Void();
 }
 
+TEST_CASE("!/redwood/correctness/unit/RedwoodValueCodec") {
+	Arena arena;
+	std::string compressible(1000, 'a');
+	for(int i = 0; i < 100; ++i) {
+		compressible[deterministicRandom()->randomInt(0, compressible.size())] = deterministicRandom()->randomAlphaNumeric(1)[0];
+	}
+	std::vector<std::string> values = { "", "x", std::string(SERVER_KNOBS->REDWOOD_VALUE_COMPRESSION_MIN_BYTES, 'b'), compressible, deterministicRandom()->randomAlphaNumeric(500) };
+
+	for(auto const &s : values) {
+		ValueRef value = StringRef(s);
+		ValueRef encoded = RedwoodValueCodec::encode(arena, value);
+		ASSERT(encoded.size() <= value.size() + 1);
+		ASSERT(RedwoodValueCodec::decode(arena, encoded) == value);
+		int maxLength = value.size() / 2;
+		ASSERT(RedwoodValueCodec::decode(arena, encoded, maxLength) == value.substr(0, maxLength));
+		if(value.size() >= SERVER_KNOBS->REDWOOD_VALUE_COMPRESSION_MIN_BYTES && s == compressible) {
+			ASSERT(encoded[0] == RedwoodValueCodec::ZLIB && encoded.size() < value.size() / 2);
+		}
+	}
+
+	return Void();
+}
+
+TEST_CASE("!/redwood/correctness/unit/MetaKey") {
+	typedef VersionedBTree::MetaKey MetaKey;
+	uint8_t currentSpace[sizeof(MetaKey) + sizeof(LogicalPageID) * 20];
+	uint8_t parsedSpace[sizeof(currentSpace)];
+	memset(currentSpace, 0, sizeof(currentSpace));
+	MetaKey &current = *(MetaKey *)currentSpace;
+	current.formatVersion = MetaKey::FORMAT_VERSION;
+	current.height = 3;
+	current.valueEncoding = VersionedBTree::COMPRESSED_VALUES;
+	memset(&current.lazyDeleteQueue, 0x5a, sizeof(current.lazyDeleteQueue));
+	LogicalPageID rootIDs[] = { 7, 11 };
+	current.root.set(BTreePageID(rootIDs, 2), sizeof(currentSpace) - sizeof(MetaKey));
+
+	// The same header as written by format version 4, which had no valueEncoding
+	std::string v4 = current.asKeyRef().toString();
+	int prefix = sizeof(current.formatVersion) + sizeof(current.height);
+	v4.erase(prefix, sizeof(current.valueEncoding));
+	uint16_t version = 4;
+	memcpy(&v4[0], &version, sizeof(version));
+
+	memset(parsedSpace, 0xff, sizeof(parsedSpace));
+	MetaKey &parsed = *(MetaKey *)parsedSpace;
+	parsed.fromKeyRef(StringRef(v4));
+	ASSERT(parsed.formatVersion == MetaKey::FORMAT_VERSION);
+	ASSERT(parsed.height == 3);
+	ASSERT(parsed.valueEncoding == VersionedBTree::RAW_VALUES);
+	ASSERT(parsed.lazyDeleteQueue == current.lazyDeleteQueue);
+	ASSERT(parsed.root.get() == current.root.get());
+
+	// Parsing the current format keeps valueEncoding
+	memset(parsedSpace, 0xff, sizeof(parsedSpace));
+	parsed.fromKeyRef(current.asKeyRef());
+	ASSERT(parsed.valueEncoding == VersionedBTree::COMPRESSED_VALUES);
+	ASSERT(parsed.asKeyRef() == current.asKeyRef());
+
+	return Void();
+}
+
 TEST_CASE("!/redwood/correctness/unit/deltaTree/RedwoodRecordRef") {
 	const int N = 200;
 
@@ -45,6 +45,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <fstream>
+#include <thread>
 #include "fdbserver/pubsub.h"
 #include "fdbserver/SimulatedCluster.h"
 #include "fdbserver/TesterInterface.actor.h"
@@ -61,6 +62,11 @@
 
 #include "fdbmonitor/SimpleIni.h"
 
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #ifdef  __linux__
 #include <execinfo.h>
 #include <signal.h>
@@ -85,7 +91,7 @@ enum {
 	OPT_DCID, OPT_MACHINE_CLASS, OPT_BUGGIFY, OPT_VERSION, OPT_CRASHONERROR, OPT_HELP, OPT_NETWORKIMPL, OPT_NOBUFSTDOUT, OPT_BUFSTDOUTERR, OPT_TRACECLOCK,
 	OPT_NUMTESTERS, OPT_DEVHELP, OPT_ROLLSIZE, OPT_MAXLOGS, OPT_MAXLOGSSIZE, OPT_KNOB, OPT_TESTSERVERS, OPT_TEST_ON_SERVERS, OPT_METRICSCONNFILE,
 	OPT_METRICSPREFIX, OPT_LOGGROUP, OPT_LOCALITY, OPT_IO_TRUST_SECONDS, OPT_IO_TRUST_WARN_ONLY, OPT_FILESYSTEM, OPT_PROFILER_RSS_SIZE, OPT_KVFILE,
-	OPT_TRACE_FORMAT, OPT_WHITELIST_BINPATH, OPT_BLOB_CREDENTIAL_FILE
+	OPT_TRACE_FORMAT, OPT_WHITELIST_BINPATH, OPT_BLOB_CREDENTIAL_FILE, OPT_SIMULATION_RUNS, OPT_SIMULATION_JOBS
 };
 
 CSimpleOpt::SOption g_rgOptions[] = {
@@ -165,6 +171,8 @@ CSimpleOpt::SOption g_rgOptions[] = {
 	{ OPT_TRACE_FORMAT      ,    "--trace_format",              SO_REQ_SEP },
 	{ OPT_WHITELIST_BINPATH,     "--whitelist_binpath",         SO_REQ_SEP },
 	{ OPT_BLOB_CREDENTIAL_FILE,  "--blob_credential_file",      SO_REQ_SEP },
+	{ OPT_SIMULATION_RUNS,       "--simulation_runs",           SO_REQ_SEP },
+	{ OPT_SIMULATION_JOBS,       "--simulation_jobs",           SO_REQ_SEP },
 
 #ifndef TLS_DISABLED
 	TLS_OPTION_FLAGS
@@ -623,6 +631,12 @@ static void printUsage( const char *name, bool devhelp ) {
 		printf("                 Restart a previous simulation that was cleanly shut down.\n");
 		printf("  -s SEED, --seed SEED\n"
 			   "                 Random seed.\n");
+		printf("  --simulation_runs RUNS\n"
+			   "                 Run RUNS simulations with seeds SEED, SEED+1, ... in separate\n");
+		printf("                 processes, each in its own directory `simulation.SEED'.\n");
+		printf("  --simulation_jobs JOBS\n"
+			   "                 Run at most JOBS simulations at a time, defaults to the\n");
+		printf("                 number of cores.\n");
 		printf("  -k KEY, --key KEY  Target key for search role.\n");
 		printf("  --kvfile FILE  Input file (SQLite database file) for use by the 'kvfilegeneratesums' and 'kvfileintegritycheck' roles.\n");
 		printf("  -b [on,off], --buggify [on,off]\n"
@@ -940,6 +954,8 @@ struct CLIOptions {
 	LocalityData localities;
 	int minTesterCount = 1;
 	bool testOnServers = false;
+	int simulationRuns = 1;
+	int simulationJobs = std::max(1u, std::thread::hardware_concurrency());
 
 	Reference<TLSPolicy> tlsPolicy = Reference<TLSPolicy>(new TLSPolicy(TLSPolicy::Is::SERVER));
 	TLSParams tlsParams;
@@ -1165,6 +1181,17 @@ private:
 				}
 				break;
 			}
+			case OPT_SIMULATION_RUNS:
+			case OPT_SIMULATION_JOBS: {
+				const char* a = args.OptionArg();
+				int& value = args.OptionId() == OPT_SIMULATION_RUNS ? simulationRuns : simulationJobs;
+				if (sscanf(a, "%d", &value) != 1 || value < 1) {
+					fprintf(stderr, "ERROR: Could not parse %s `%s'\n", args.OptionText(), a);
+					printHelpTeaser(argv[0]);
+					flushAndExit(FDB_EXIT_ERROR);
+				}
+				break;
+			}
 			case OPT_ROLLSIZE: {
 				const char* a = args.OptionArg();
 				ti = parse_with_suffix(a);
@@ -1480,6 +1507,18 @@ private:
 			if (buggifyOverride.present()) buggifyEnabled = buggifyOverride.get();
 		}
 
+		if (simulationRuns > 1 && role != Simulation) {
+			fprintf(stderr, "ERROR: --simulation_runs is only supported by the simulation role\n");
+			printHelpTeaser(argv[0]);
+			flushAndExit(FDB_EXIT_ERROR);
+		}
+#ifdef _WIN32
+		if (simulationRuns > 1) {
+			fprintf(stderr, "ERROR: --simulation_runs is not supported on Windows\n");
+			flushAndExit(FDB_EXIT_ERROR);
+		}
+#endif
+
 		if (role == SearchMutations && !targetKey) {
 			fprintf(stderr, "ERROR: please specify a target key\n");
 			printHelpTeaser(argv[0]);
@@ -1520,6 +1559,65 @@ private:
 		if (!localities.isPresent(LocalityData::keyDcId) && dcId.present()) localities.set(LocalityData::keyDcId, dcId);
 	}
 };
+
+#ifndef _WIN32
+// Runs opts.simulationRuns simulations with consecutive seeds, at most opts.simulationJobs at a time.  The simulator
+// and everything it touches are process wide, so each run is a child process of its own, working in the directory
+// simulation.<seed> (where its output goes to simulation.out) so that runs do not share files either.  Returns only
+// in a child, with opts changed to describe its run; the parent exits once every run has finished, failing if any did.
+void forkSimulationRuns(CLIOptions& opts) {
+	static std::string testFile;
+	testFile = abspath(opts.testFile);
+	int failed = 0;
+	int started = 0;
+	std::map<pid_t, uint32_t> running;
+
+	fflush(stdout);
+	fflush(stderr);
+	while (started < opts.simulationRuns || !running.empty()) {
+		if (started < opts.simulationRuns && running.size() < opts.simulationJobs) {
+			uint32_t seed = opts.randomSeed + started++;
+			pid_t pid = fork();
+			if (pid < 0) {
+				fprintf(stderr, "ERROR: Could not start the simulation with seed %u\n", seed);
+				flushAndExit(FDB_EXIT_ERROR);
+			}
+			if (pid == 0) {
+				std::string runDir = format("simulation.%u", seed);
+				if (!platform::createDirectory(runDir) || chdir(runDir.c_str()) != 0 ||
+				    !freopen("simulation.out", "w", stdout) || dup2(fileno(stdout), fileno(stderr)) < 0) {
+					_exit(FDB_EXIT_ERROR);
+				}
+				opts.randomSeed = seed;
+				opts.testFile = testFile.c_str();
+				if (!opts.logFolder.empty() && opts.logFolder[0] == '/') opts.logFolder = joinPath(opts.logFolder, runDir);
+				if (!opts.dataFolder.empty() && opts.dataFolder[0] == '/') opts.dataFolder = joinPath(opts.dataFolder, runDir);
+				opts.simulationRuns = 1;
+				return;
+			}
+			running[pid] = seed;
+			continue;
+		}
+
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0) {
+			if (errno == EINTR) continue;
+			fprintf(stderr, "ERROR: Lost track of %d running simulations\n", (int)running.size());
+			flushAndExit(FDB_EXIT_ERROR);
+		}
+		auto run = running.find(pid);
+		if (run == running.end()) continue;
+		bool passed = WIFEXITED(status) && WEXITSTATUS(status) == FDB_EXIT_SUCCESS;
+		if (!passed) failed++;
+		printf("Simulation with seed %u %s, see simulation.%u/\n", run->second, passed ? "passed" : "FAILED", run->second);
+		running.erase(run);
+	}
+
+	printf("%d of %d simulations failed\n", failed, opts.simulationRuns);
+	flushAndExit(failed ? FDB_EXIT_ERROR : FDB_EXIT_SUCCESS);
+}
+#endif
 } // namespace
 
 int main(int argc, char* argv[]) {
@@ -1543,7 +1641,12 @@ int main(int argc, char* argv[]) {
 		//_set_output_format(_TWO_DIGIT_EXPONENT);
 #endif
 
-		const auto opts = CLIOptions::parseArgs(argc, argv);
+		auto opts = CLIOptions::parseArgs(argc, argv);
+#ifndef _WIN32
+		if (opts.simulationRuns > 1) {
+			forkSimulationRuns(opts);
+		}
+#endif
 		const auto role = opts.role;
 
 		if (role == Simulation) printf("Random seed is %u...\n", opts.randomSeed);
@@ -251,6 +251,105 @@ struct FetchInjectionInfo {
 	vector<VerUpdateRef> changes;
 };
 
+// Caches values read from the storage engine for keys which are read frequently.
+// A key is only filled while it has no mutations in the versioned map, so a cached value is the value in the storage engine,
+// and it is invalidated by any mutation or shard change touching the key. The cache is therefore only valid for reads
+// which would otherwise have gone to the storage engine, i.e. reads which found nothing for the key in the versioned map.
+struct HotValueCache {
+	HotValueCache() : bytes(0), nextFillID(1), sampleStart(0) {}
+
+	bool enabled() const { return SERVER_KNOBS->HOT_VALUE_CACHE_BYTES > 0; }
+
+	// Returns true and sets value if key is in the cache
+	bool get( KeyRef key, Optional<Value>& value ) {
+		auto it = entries.find(key);
+		if (it == entries.end() || it->second.fillID) return false;
+		lru.splice(lru.end(), lru, it->second.lruPosition);
+		value = it->second.value;
+		return true;
+	}
+
+	// Counts a read of key which went to the storage engine. If key has become hot, returns a non-zero fill ID which must be
+	// passed to endFill() with the value read, otherwise returns 0.
+	int64_t beginFill( KeyRef key ) {
+		if (now() - sampleStart >= SERVER_KNOBS->HOT_VALUE_CACHE_SAMPLE_INTERVAL) {
+			readCounts.clear();
+			sampleStart = now();
+		}
+		auto count = readCounts.find(key);
+		if (count == readCounts.end()) {
+			if (readCounts.size() >= SERVER_KNOBS->HOT_VALUE_CACHE_MAX_TRACKED_KEYS) return 0;
+			count = readCounts.insert(std::make_pair(Key(key), 0)).first;
+		}
+		if (++count->second < SERVER_KNOBS->HOT_VALUE_CACHE_MIN_READS || entries.count(key)) return 0;
+
+		auto it = entries.insert(std::make_pair(Key(key), Entry())).first;
+		it->second.fillID = nextFillID++;
+		it->second.lruPosition = lru.insert(lru.end(), it->first);
+		bytes += entrySize(it->first, it->second);
+		evict();
+		return it->second.fillID;
+	}
+
+	void endFill( KeyRef key, int64_t fillID, Optional<Value> const& value ) {
+		auto it = entries.find(key);
+		if (it == entries.end() || it->second.fillID != fillID) return; // Invalidated or evicted while reading
+		if (value.present() && value.get().size() > SERVER_KNOBS->HOT_VALUE_CACHE_MAX_VALUE_BYTES) {
+			erase(it);
+			return;
+		}
+		it->second.fillID = 0;
+		it->second.value = value;
+		bytes += value.present() ? value.get().size() : 0;
+		evict();
+	}
+
+	void invalidate( KeyRef key ) {
+		auto it = entries.find(key);
+		if (it != entries.end()) erase(it);
+	}
+
+	void invalidate( KeyRangeRef keys ) {
+		auto it = entries.lower_bound(keys.begin);
+		while (it != entries.end() && it->first < keys.end) erase(it++);
+	}
+
+	int64_t getBytes() const { return bytes; }
+	int64_t getEntryCount() const { return entries.size(); }
+
+private:
+	struct Entry {
+		Optional<Value> value;
+		int64_t fillID; // Non-zero while the value is being read from the storage engine
+		std::list<Key>::iterator lruPosition;
+
+		Entry() : fillID(0) {}
+	};
+
+	std::map<Key, Entry, std::less<>> entries;
+	std::list<Key> lru; // Least recently used first
+	std::map<Key, int, std::less<>> readCounts; // Reads per key in the current sample interval
+	int64_t bytes;
+	int64_t nextFillID;
+	double sampleStart;
+
+	static int64_t entrySize( KeyRef key, Entry const& e ) {
+		return 2 * key.size() + sizeof(Entry) + (e.value.present() ? e.value.get().size() : 0);
+	}
+
+	void erase( std::map<Key, Entry, std::less<>>::iterator it ) {
+		bytes -= entrySize(it->first, it->second);
+		lru.erase(it->second.lruPosition);
+		entries.erase(it);
+	}
+
+	void evict() {
+		while (bytes > SERVER_KNOBS->HOT_VALUE_CACHE_BYTES && !lru.empty()) {
+			erase(entries.find(lru.front()));
+		}
+	}
+};
+
 struct StorageServer {
 	typedef VersionedMap<KeyRef, ValueOrClearToRef> VersionedData;
 
@@ -451,6 +550,8 @@ public:
 
 	Optional<LatencyBandConfig> latencyBandConfig;
 
+	HotValueCache hotValueCache;
+
 	struct Counters {
 		CounterCollection cc;
 		Counter allQueries, getKeyQueries, getValueQueries, getRangeQueries, finishedQueries, rowsQueried, bytesQueried, watchQueries, emptyQueries;
@@ -462,6 +563,7 @@ public:
 		Counter loops;
 		Counter fetchWaitingMS, fetchWaitingCount, fetchExecutingMS, fetchExecutingCount;
 		Counter readsRejected;
+		Counter hotValueCacheHits, hotValueCacheMisses;
 
 		LatencyBands readLatencyBands;
 
@@ -493,6 +595,8 @@ public:
 			fetchExecutingMS("FetchExecutingMS", cc),
 			fetchExecutingCount("FetchExecutingCount", cc),
 			readsRejected("ReadsRejected", cc),
+			hotValueCacheHits("HotValueCacheHits", cc),
+			hotValueCacheMisses("HotValueCacheMisses", cc),
 			readLatencyBands("ReadLatencyMetrics", self->thisServerID, SERVER_KNOBS->STORAGE_LOGGING_DELAY)
 		{
 			specialCounter(cc, "LastTLogVersion", [self](){ return self->lastTLogVersion; });
@@ -512,6 +616,8 @@ public:
 
 			specialCounter(cc, "BytesStored", [self](){ return self->metrics.byteSample.getEstimate(allKeys); });
 			specialCounter(cc, "ActiveWatches", [self](){ return self->numWatches; });
+			specialCounter(cc, "HotValueCacheBytes", [self](){ return self->hotValueCache.getBytes(); });
+			specialCounter(cc, "HotValueCacheEntries", [self](){ return self->hotValueCache.getEntryCount(); });
 			specialCounter(cc, "WatchBytes", [self](){ return self->watchBytes; });
 
 			specialCounter(cc, "KvstoreBytesUsed", [self](){ return self->storage.getStorageBytes().used; });
@@ -559,6 +665,7 @@ public:
 	void addShard( ShardInfo* newShard ) {
 		ASSERT( !newShard->keys.empty() );
 		newShard->changeCounter = ++shardChangeCounter;
+		hotValueCache.invalidate( newShard->keys );
 		//TraceEvent("AddShard", this->thisServerID).detail("KeyBegin", newShard->keys.begin).detail("KeyEnd", newShard->keys.end).detail("State", newShard->isReadable() ? "Readable" : newShard->notAssigned() ? "NotAssigned" : "Adding").detail("Version", this->version.get());
 		/*auto affected = shards.getAffectedRangesAfterInsertion( newShard->keys, Reference<ShardInfo>() );
 		for(auto i = affected.begin(); i != affected.end(); ++i)
@@ -860,18 +967,35 @@ ACTOR Future<Void> getValueQ( StorageServer* data, GetValueRequest req ) {
 			path = 1;
 		} else if (!i || !i->isClearTo() || i->getEndKey() <= req.key) {
 			path = 2;
-			Optional<Value> vv = wait( data->storage.readValue( req.key, req.debugID ) );
-			// Validate that while we were reading the data we didn't lose the version or shard
-			if (version < data->storageVersion()) {
-				TEST(true); // transaction_too_old after readValue
-				throw transaction_too_old();
+			state int64_t fillID = 0;
+			if (data->hotValueCache.enabled()) {
+				if (data->hotValueCache.get(req.key, v)) {
+					++data->counters.hotValueCacheHits;
+					path = 3;
+				} else {
+					++data->counters.hotValueCacheMisses;
+					// Only keys without pending mutations may be filled, see HotValueCache
+					auto latest = data->data().atLatest().lastLessOrEqual(req.key);
+					if (!latest || (latest.key() != req.key && (!latest->isClearTo() || latest->getEndKey() <= req.key))) {
+						fillID = data->hotValueCache.beginFill(req.key);
+					}
+				}
+			}
+			if (path == 2) {
+				Optional<Value> vv = wait( data->storage.readValue( req.key, req.debugID ) );
+				// Validate that while we were reading the data we didn't lose the version or shard
+				if (version < data->storageVersion()) {
+					TEST(true); // transaction_too_old after readValue
+					throw transaction_too_old();
+				}
+				data->checkChangeCounter(changeCounter, req.key);
+				if (fillID) data->hotValueCache.endFill(req.key, fillID, vv);
+				v = vv;
 			}
-			data->checkChangeCounter(changeCounter, req.key);
-			v = vv;
 		}
 
 		debugMutation("ShardGetValue", version, MutationRef(MutationRef::DebugKey, req.key, v.present()?v.get():LiteralStringRef("<null>")));
-		debugMutation("ShardGetPath", version, MutationRef(MutationRef::DebugKey, req.key, path==0?LiteralStringRef("0"):path==1?LiteralStringRef("1"):LiteralStringRef("2")));
+		debugMutation("ShardGetPath", version, MutationRef(MutationRef::DebugKey, req.key, path==0?LiteralStringRef("0"):path==1?LiteralStringRef("1"):path==2?LiteralStringRef("2"):LiteralStringRef("3")));
 
 		/*
 		StorageMetrics m;
@@ -913,7 +1037,7 @@ ACTOR Future<Void> getValueQ( StorageServer* data, GetValueRequest req ) {
 	--data->readQueueSizeMetric;
 	if(data->latencyBandConfig.present()) {
 		int maxReadBytes = data->latencyBandConfig.get().readConfig.maxReadBytes.orDefault(std::numeric_limits<int>::max());
-		data->counters.readLatencyBands.addMeasurement(timer() - req.requestTime(), resultSize > maxReadBytes);
+		data->counters.readLatencyBands.addMeasurement(g_network->timer() - req.requestTime(), resultSize > maxReadBytes);
 	}
 
 	return Void();
@@ -1460,7 +1584,7 @@ ACTOR Future<Void> getKeyValues( StorageServer* data, GetKeyValuesRequest req )
 		int maxReadBytes = data->latencyBandConfig.get().readConfig.maxReadBytes.orDefault(std::numeric_limits<int>::max());
 		int maxSelectorOffset = data->latencyBandConfig.get().readConfig.maxKeySelectorOffset.orDefault(std::numeric_limits<int>::max());
 		data->counters.readLatencyBands.addMeasurement(
-		    timer() - req.requestTime(), resultSize > maxReadBytes || abs(req.begin.offset) > maxSelectorOffset ||
+		    g_network->timer() - req.requestTime(), resultSize > maxReadBytes || abs(req.begin.offset) > maxSelectorOffset ||
 		                                     abs(req.end.offset) > maxSelectorOffset);
 	}
 
@@ -1518,7 +1642,7 @@ ACTOR Future<Void> getKey( StorageServer* data, GetKeyRequest req ) {
 		int maxReadBytes = data->latencyBandConfig.get().readConfig.maxReadBytes.orDefault(std::numeric_limits<int>::max());
 		int maxSelectorOffset = data->latencyBandConfig.get().readConfig.maxKeySelectorOffset.orDefault(std::numeric_limits<int>::max());
 		data->counters.readLatencyBands.addMeasurement(
-		    timer() - req.requestTime(), resultSize > maxReadBytes || abs(req.sel.offset) > maxSelectorOffset);
+		    g_network->timer() - req.requestTime(), resultSize > maxReadBytes || abs(req.sel.offset) > maxSelectorOffset);
 	}
 
 	return Void();
@@ -1768,12 +1892,14 @@ void applyMutation( StorageServer *self, MutationRef const& m, Arena& arena, Sto
 			}
 		}
 		data.insert( m.param1, ValueOrClearToRef::value(m.param2) );
+		self->hotValueCache.invalidate( m.param1 );
 		self->watches.trigger( m.param1 );
 	} else if (m.type == MutationRef::ClearRange) {
 		data.erase( m.param1, m.param2 );
 		ASSERT( m.param2 > m.param1 );
 		ASSERT( !data.isClearContaining( data.atLatest(), m.param1 ) );
 		data.insert( m.param1, ValueOrClearToRef::clearTo(m.param2) );
+		self->hotValueCache.invalidate( KeyRangeRef(m.param1, m.param2) );
 		self->watches.triggerRange( m.param1, m.param2 );
 	}
 
@@ -1786,6 +1912,7 @@ void removeDataRange( StorageServer *ss, Standalone<VersionUpdateRef> &mLV, KeyR
 
 	MutationRef clearRange( MutationRef::ClearRange, range.begin, range.end );
 	clearRange = ss->addMutationToMutationLog( mLV, clearRange );
+	ss->hotValueCache.invalidate( range );
 
 	auto& data = ss->mutableData();
 
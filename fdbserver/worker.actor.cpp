@@ -556,9 +556,25 @@ void runHeapProfiler(const char* msg) {
 #endif
 }
 
+// Writes the activity of each actor type over the next req.duration seconds to req.outputFile.  The counters are
+// always being collected (in builds with ACTOR_PROFILING), so DISABLE has nothing to do.
+ACTOR Future<Void> runActorProfiler(ProfilerRequest req) {
+	state ActorProfileSnapshot start;
+	if (req.action == ProfilerRequest::Action::RUN) {
+		start = getActorProfiles();
+		wait(delay(req.duration));
+	}
+	if (req.action != ProfilerRequest::Action::DISABLE) {
+		writeActorProfiles(req.outputFile.toString(), start);
+	}
+	return Void();
+}
+
 ACTOR Future<Void> runProfiler(ProfilerRequest req) {
 	if (req.type == ProfilerRequest::Type::GPROF_HEAP) {
 		runHeapProfiler("User triggered heap dump");
+	} else if (req.type == ProfilerRequest::Type::ACTORS) {
+		wait( runActorProfiler(req) );
 	} else {
 		wait( runCpuProfiler(req) );
 	}
@@ -792,9 +808,10 @@ ACTOR Future<Void> monitorServerDBInfo(Reference<AsyncVar<Optional<ClusterContro
 	dbInfo->set(localInfo);
 
 	state Optional<double> incorrectTime;
+	state bool needFullInfo = false;
 	loop {
 		GetServerDBInfoRequest req;
-		req.knownServerInfoID = dbInfo->get().id;
+		req.knownServerInfoID = needFullInfo ? UID() : dbInfo->get().id;
 
 		if (issues.present()) {
 			for (auto const& i : issues.get()->get()) {
@@ -832,14 +849,21 @@ ACTOR Future<Void> monitorServerDBInfo(Reference<AsyncVar<Optional<ClusterContro
 		}
 
 		choose {
-			when( CachedSerialization<ServerDBInfo> ni = wait( ccInterface->get().present() ? brokenPromiseToNever( ccInterface->get().get().getServerDBInfo.getReply( req ) ) : Never() ) ) {
-				ServerDBInfo localInfo = ni.read();
-				TraceEvent("GotServerDBInfoChange").detail("ChangeID", localInfo.id).detail("MasterID", localInfo.master.id())
-				.detail("RatekeeperID", localInfo.ratekeeper.present() ? localInfo.ratekeeper.get().id() : UID())
-				.detail("DataDistributorID", localInfo.distributor.present() ? localInfo.distributor.get().id() : UID());
-
-				localInfo.myLocality = locality;
-				dbInfo->set(localInfo);
+			when( CachedSerialization<ServerDBInfoUpdate> update = wait( ccInterface->get().present() ? brokenPromiseToNever( ccInterface->get().get().getServerDBInfo.getReply( req ) ) : Never() ) ) {
+				ServerDBInfo localInfo = dbInfo->get();
+				needFullInfo = !update.read().apply(localInfo);
+				if(needFullInfo) {
+					// The cluster controller sent a delta from a ServerDBInfo we no longer have, so ask for all of it
+					TraceEvent(SevWarn, "ServerDBInfoDeltaMismatch").detail("KnownID", localInfo.id).detail("BaseID", update.read().baseID);
+				} else if(localInfo.id != dbInfo->get().id) {
+					TraceEvent("GotServerDBInfoChange").detail("ChangeID", localInfo.id).detail("MasterID", localInfo.master.id())
+					.detail("RatekeeperID", localInfo.ratekeeper.present() ? localInfo.ratekeeper.get().id() : UID())
+					.detail("DataDistributorID", localInfo.distributor.present() ? localInfo.distributor.get().id() : UID())
+					.detail("ChangedFields", update.read().full.present() ? (int)ServerDBInfo::FIELD_COUNT : (int)update.read().changedFields.size());
+
+					localInfo.myLocality = locality;
+					dbInfo->set(localInfo);
+				}
 			}
 			when( wait( ccInterface->onChange() ) ) {
 				if(ccInterface->get().present())
@@ -970,7 +994,7 @@ ACTOR Future<Void> workerServer(
 			DiskStore s = stores[f];
 			// FIXME: Error handling
 			if( s.storedComponent == DiskStore::Storage ) {
-				IKeyValueStore* kv = openKVStore(s.storeType, s.filename, s.storeID, memoryLimit, false, validateDataFiles);
+				IKeyValueStore* kv = openStorageKVStore(s.storeType, s.filename, s.storeID, memoryLimit, false, validateDataFiles);
 				Future<Void> kvClosed = kv->onClosed();
 				filesClosed.add( kvClosed );
 
@@ -1096,8 +1120,10 @@ ACTOR Future<Void> workerServer(
 				try {
 					std::string realLogDir = abspath(SERVER_KNOBS->LOG_DIRECTORY);
 					std::string realOutPath = abspath(realLogDir + "/" + profilerReq.outputFile.toString());
-					if (realLogDir.size() < realOutPath.size() &&
-					    strncmp(realLogDir.c_str(), realOutPath.c_str(), realLogDir.size()) == 0) {
+					if (profilerReq.type == ProfilerRequest::Type::ACTORS && !actorProfilingEnabled()) {
+						profilerReq.reply.sendError(unsupported_operation());
+					} else if (realLogDir.size() < realOutPath.size() &&
+					           strncmp(realLogDir.c_str(), realOutPath.c_str(), realLogDir.size()) == 0) {
 						profilerReq.outputFile = realOutPath;
 						uncancellable(runProfiler(profilerReq));
 						profilerReq.reply.send(Void());
@@ -1243,7 +1269,7 @@ ACTOR Future<Void> workerServer(
 					//printf("Recruited as storageServer\n");
 
 					std::string filename = filenameFromId( req.storeType, folder, fileStoragePrefix.toString(), recruited.id() );
-					IKeyValueStore* data = openKVStore( req.storeType, filename, recruited.id(), memoryLimit );
+					IKeyValueStore* data = openStorageKVStore( req.storeType, filename, recruited.id(), memoryLimit );
 					Future<Void> kvClosed = data->onClosed();
 					filesClosed.add( kvClosed );
 					ReplyPromise<InitializeStorageReply> storageReady = req.reply;
@@ -0,0 +1,111 @@
+/*
+ * RYWReadCache.actor.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fdbclient/NativeAPI.actor.h"
+#include "fdbserver/TesterInterface.actor.h"
+#include "fdbclient/ReadYourWrites.h"
+#include "fdbserver/workloads/workloads.actor.h"
+#include "flow/actorcompiler.h"  // This must be the last #include.
+
+// Checks that a ReadYourWritesTransaction reads each key it has not written from the database at most once: repeated
+// gets, and gets of keys an earlier getRange returned, are answered from its snapshot cache.  Counts reads through
+// the DatabaseContext's LogicalUncachedReads counter, so it must be the only workload issuing reads.
+struct RYWReadCacheWorkload : TestWorkload {
+	int nodes;
+	bool passed;
+
+	RYWReadCacheWorkload(WorkloadContext const& wcx) : TestWorkload(wcx), passed(true) {
+		nodes = getOption(options, LiteralStringRef("nodes"), 10);
+	}
+
+	virtual std::string description() { return "RYWReadCache"; }
+
+	Key keyForIndex(int n) { return StringRef(format("rywreadcache/%08d", n)); }
+
+	virtual Future<Void> setup(Database const& cx) {
+		if (clientId == 0) return _setup(cx, this);
+		return Void();
+	}
+
+	virtual Future<Void> start(Database const& cx) {
+		if (clientId == 0) return _start(cx, this);
+		return Void();
+	}
+
+	virtual Future<bool> check(Database const& cx) { return passed; }
+
+	virtual void getMetrics(vector<PerfMetric>& m) {}
+
+	ACTOR static Future<Void> _setup(Database cx, RYWReadCacheWorkload* self) {
+		state Transaction tr(cx);
+		loop {
+			try {
+				// Only the even keys exist, so that reads of missing keys are cached too
+				for (int i = 0; i < self->nodes; i += 2) tr.set(self->keyForIndex(i), StringRef(format("%d", i)));
+				wait(tr.commit());
+				return Void();
+			} catch (Error& e) {
+				wait(tr.onError(e));
+			}
+		}
+	}
+
+	void expectCached(Database const& cx, int64_t readsBefore, const char* read) {
+		if (cx->transactionLogicalReads.getValue() != readsBefore) {
+			TraceEvent(SevError, "RYWReadCacheMiss").detail("Read", read);
+			passed = false;
+		}
+	}
+
+	ACTOR static Future<Void> _start(Database cx, RYWReadCacheWorkload* self) {
+		state ReadYourWritesTransaction tr(cx);
+		state int64_t reads;
+		loop {
+			try {
+				state Optional<Value> present = wait(tr.get(self->keyForIndex(0)));
+				state Optional<Value> missing = wait(tr.get(self->keyForIndex(1)));
+				reads = cx->transactionLogicalReads.getValue();
+				state Optional<Value> presentAgain = wait(tr.get(self->keyForIndex(0)));
+				self->expectCached(cx, reads, "RepeatedGet");
+				Optional<Value> missingAgain = wait(tr.get(self->keyForIndex(1)));
+				self->expectCached(cx, reads, "RepeatedGetOfMissingKey");
+				if (!present.present() || presentAgain != present || missing.present() || missingAgain.present()) {
+					TraceEvent(SevError, "RYWReadCacheWrongValue");
+					self->passed = false;
+				}
+
+				state Standalone<RangeResultRef> range =
+				    wait(tr.getRange(KeyRangeRef(self->keyForIndex(2), self->keyForIndex(self->nodes)), self->nodes));
+				reads = cx->transactionLogicalReads.getValue();
+				Optional<Value> inRange = wait(tr.get(self->keyForIndex(2)));
+				self->expectCached(cx, reads, "GetAfterGetRange");
+				if (range.empty() || inRange != range[0].value) {
+					TraceEvent(SevError, "RYWReadCacheWrongValue").detail("Read", "GetAfterGetRange");
+					self->passed = false;
+				}
+				return Void();
+			} catch (Error& e) {
+				wait(tr.onError(e));
+			}
+		}
+	}
+};
+
+WorkloadFactory<RYWReadCacheWorkload> RYWReadCacheWorkloadFactory("RYWReadCache");
@@ -0,0 +1,132 @@
+/*
+ * ActorProfiler.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flow/ActorProfiler.h"
+#include "flow/Knobs.h"
+#include "flow/ThreadPrimitives.h"
+#include "flow/Trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdio.h>
+#include <vector>
+
+thread_local ActorProfilerScope* g_actorProfilerScope = nullptr;
+thread_local uint64_t g_actorProfilerArenaBytes = 0;
+
+namespace {
+
+struct CStringLess {
+	bool operator()(const char* a, const char* b) const { return strcmp(a, b) < 0; }
+};
+
+// Profiles are never freed, so references handed out by ActorProfile::get() stay valid for the life of the process.
+// The registry is only locked the first time each generated function looks up its profile.
+struct ActorProfileRegistry {
+	Mutex mutex;
+	std::map<const char*, ActorProfile*, CStringLess> profiles;
+};
+
+ActorProfileRegistry& registry() {
+	static ActorProfileRegistry* r = new ActorProfileRegistry;
+	return *r;
+}
+
+struct ActorProfileDelta {
+	std::string name;
+	ActorProfileCounts counts;
+};
+
+// Returns the activity of each actor type since `since`, busiest first
+std::vector<ActorProfileDelta> activitySince(ActorProfileSnapshot const& current, ActorProfileSnapshot const& since) {
+	std::vector<ActorProfileDelta> deltas;
+	for (auto const& p : current) {
+		ActorProfileDelta d{ p.first, p.second };
+		auto prev = since.find(p.first);
+		if (prev != since.end()) {
+			d.counts.runs -= prev->second.runs;
+			d.counts.cycles -= prev->second.cycles;
+			d.counts.arenaBytes -= prev->second.arenaBytes;
+		}
+		if (d.counts.runs) deltas.push_back(std::move(d));
+	}
+	std::sort(deltas.begin(), deltas.end(), [](ActorProfileDelta const& a, ActorProfileDelta const& b) {
+		return a.counts.cycles > b.counts.cycles;
+	});
+	return deltas;
+}
+
+} // namespace
+
+ActorProfile& ActorProfile::get(const char* name) {
+	auto& r = registry();
+	MutexHolder holder(r.mutex);
+	auto& profile = r.profiles[name];
+	if (!profile) profile = new ActorProfile(name);
+	return *profile;
+}
+
+ActorProfileSnapshot getActorProfiles() {
+	auto& r = registry();
+	MutexHolder holder(r.mutex);
+	ActorProfileSnapshot snapshot;
+	for (auto const& p : r.profiles) {
+		snapshot[p.first] = *p.second;
+	}
+	return snapshot;
+}
+
+void logActorProfiles() {
+	static ActorProfileSnapshot lastLogged;
+	ActorProfileSnapshot current = getActorProfiles();
+	if (current.empty()) return;
+
+	auto deltas = activitySince(current, lastLogged);
+	int logged = std::min<int>(deltas.size(), FLOW_KNOBS->ACTOR_PROFILER_LOGGED_ACTORS);
+	for (int i = 0; i < logged; i++) {
+		TraceEvent("ActorProfile")
+		    .detail("Actor", deltas[i].name)
+		    .detail("Rank", i)
+		    .detail("Runs", deltas[i].counts.runs)
+		    .detail("Cycles", deltas[i].counts.cycles)
+		    .detail("ArenaBytes", deltas[i].counts.arenaBytes);
+	}
+	lastLogged = std::move(current);
+}
+
+void writeActorProfiles(std::string const& filename, ActorProfileSnapshot const& since) {
+#ifndef ENABLE_ACTOR_PROFILING
+	TraceEvent("ProfilerError").detail("Message", "ActorProfiler Unsupported");
+#else
+	auto deltas = activitySince(getActorProfiles(), since);
+	FILE* f = fopen(filename.c_str(), "w");
+	if (!f) {
+		TraceEvent(SevWarn, "ActorProfileWriteFailed").GetLastError().detail("Filename", filename);
+		return;
+	}
+	fprintf(f, "%-20s %-20s %-20s %s\n", "Cycles", "Runs", "ArenaBytes", "Actor");
+	for (auto const& d : deltas) {
+		fprintf(f, "%-20llu %-20llu %-20llu %s\n", (unsigned long long)d.counts.cycles,
+		        (unsigned long long)d.counts.runs, (unsigned long long)d.counts.arenaBytes, d.name.c_str());
+	}
+	fclose(f);
+	TraceEvent("ActorProfileWritten").detail("Filename", filename).detail("Actors", deltas.size());
+#endif
+}
@@ -0,0 +1,102 @@
+/*
+ * ActorProfiler.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_ACTOR_PROFILER_H
+#define FLOW_ACTOR_PROFILER_H
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#include "flow/Platform.h"
+
+// Per actor type execution statistics.  When the build sets ACTOR_PROFILING the actor compiler is run with
+// --generate-profiling, and every entry into an actor body (the initial call and each callback) is wrapped in an
+// ActorProfilerScope.  Scopes nest when an actor synchronously runs another one (e.g. by sending to a promise),
+// and the time and arena bytes of the inner scope are charged to the inner actor only.
+
+struct ActorProfileCounts {
+	uint64_t runs = 0;
+	uint64_t cycles = 0; // rdtsc ticks spent in the actor itself
+	uint64_t arenaBytes = 0; // Bytes of arena blocks allocated while the actor itself was running
+};
+
+struct ActorProfile : ActorProfileCounts {
+	const char* name;
+
+	// Returns the (process lifetime) profile for the actor type with the given name
+	static ActorProfile& get(const char* name);
+
+private:
+	explicit ActorProfile(const char* name) : name(name) {}
+};
+
+extern thread_local struct ActorProfilerScope* g_actorProfilerScope;
+extern thread_local uint64_t g_actorProfilerArenaBytes;
+
+struct ActorProfilerScope {
+	explicit ActorProfilerScope(ActorProfile& profile)
+	  : profile(profile), parent(g_actorProfilerScope), childCycles(0), childArenaBytes(0),
+	    startArenaBytes(g_actorProfilerArenaBytes), startCycles(__rdtsc()) {
+		g_actorProfilerScope = this;
+	}
+
+	~ActorProfilerScope() {
+		uint64_t cycles = __rdtsc() - startCycles;
+		uint64_t arenaBytes = g_actorProfilerArenaBytes - startArenaBytes;
+		profile.runs++;
+		profile.cycles += cycles - childCycles;
+		profile.arenaBytes += arenaBytes - childArenaBytes;
+		if (parent) {
+			parent->childCycles += cycles;
+			parent->childArenaBytes += arenaBytes;
+		}
+		g_actorProfilerScope = parent;
+	}
+
+private:
+	ActorProfile& profile;
+	ActorProfilerScope* parent;
+	uint64_t childCycles, childArenaBytes;
+	uint64_t startArenaBytes, startCycles;
+};
+
+typedef std::map<std::string, ActorProfileCounts> ActorProfileSnapshot;
+
+// Whether this binary was built with ACTOR_PROFILING; without it no actor is instrumented and there is nothing to report
+inline bool actorProfilingEnabled() {
+#ifdef ENABLE_ACTOR_PROFILING
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Copies the counters of every actor type that has run so far
+ActorProfileSnapshot getActorProfiles();
+
+// Logs an ActorProfile trace event for each of the busiest actor types since the previous call
+void logActorProfiles();
+
+// Writes a table of the activity of every actor type since `since` to the given file, busiest first
+void writeActorProfiles(std::string const& filename, ActorProfileSnapshot const& since);
+
+#endif
@@ -28,6 +28,9 @@
 #include "flow/Trace.h"
 #include "flow/ObjectSerializerTraits.h"
 #include "flow/FileIdentifier.h"
+#ifdef ENABLE_ACTOR_PROFILING
+#include "flow/ActorProfiler.h"
+#endif
 #include <algorithm>
 #include <stdint.h>
 #include <string>
@@ -219,6 +222,9 @@ struct ArenaBlock : NonCopyable, ThreadSafeReferenceCounted<ArenaBlock>
 	// Return an appropriately-sized ArenaBlock to store the given data
 	static ArenaBlock* create( int dataSize, Reference<ArenaBlock>& next ) {
 		ArenaBlock* b;
+#ifdef ENABLE_ACTOR_PROFILING
+		g_actorProfilerArenaBytes += dataSize;
+#endif
 		if (dataSize <= SMALL-TINY_HEADER && !next) {
 			if (dataSize <= 16-TINY_HEADER) { b = (ArenaBlock*)FastAllocator<16>::allocate(); b->tinySize = 16; INSTRUMENT_ALLOCATE("Arena16"); }
 			else if (dataSize <= 32-TINY_HEADER) { b = (ArenaBlock*)FastAllocator<32>::allocate(); b->tinySize = 32; INSTRUMENT_ALLOCATE("Arena32"); }
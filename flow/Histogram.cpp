@@ -0,0 +1,147 @@
+/*
+ * Histogram.cpp
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flow/Histogram.h"
+#include "flow/Knobs.h"
+#include "flow/Trace.h"
+#include "flow/UnitTest.h"
+
+#include <algorithm>
+#include <map>
+#include <stdlib.h>
+
+int LatencyHistogram::bucketFor(uint64_t micros) {
+	if (micros < SUB_BUCKETS) return micros;
+	int exponent = 63 - clzll(micros);
+	if (exponent > MAX_EXPONENT) return BUCKETS - 1;
+	int subBucket = (micros >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKETS;
+	return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + subBucket;
+}
+
+double LatencyHistogram::bucketUpperBound(int bucket) {
+	if (bucket < SUB_BUCKETS) return (bucket + 1) * 1e-6;
+	int exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+	int subBucket = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+	return (uint64_t(SUB_BUCKETS + subBucket + 1) << (exponent - SUB_BUCKET_BITS)) * 1e-6;
+}
+
+void LatencyHistogram::merge(LatencyHistogram const& other) {
+	for (int i = 0; i < BUCKETS; i++) buckets[i] += other.buckets[i];
+	total += other.total;
+}
+
+void LatencyHistogram::clear() {
+	std::fill(buckets, buckets + BUCKETS, 0);
+	total = 0;
+}
+
+double LatencyHistogram::percentile(double fraction) const {
+	if (!total) return 0;
+	uint64_t target = std::max<uint64_t>(1, uint64_t(fraction * total + 0.5));
+	uint64_t seen = 0;
+	for (int i = 0; i < BUCKETS; i++) {
+		seen += buckets[i];
+		if (seen >= target) return bucketUpperBound(i);
+	}
+	return bucketUpperBound(BUCKETS - 1);
+}
+
+std::string LatencyHistogram::encode() const {
+	std::string result;
+	for (int i = 0; i < BUCKETS; i++) {
+		if (!buckets[i]) continue;
+		if (!result.empty()) result += ' ';
+		result += format("%d:%u", i, buckets[i]);
+	}
+	return result;
+}
+
+bool LatencyHistogram::mergeEncoded(std::string const& encoded) {
+	LatencyHistogram decoded;
+	const char* p = encoded.c_str();
+	while (*p) {
+		char* end;
+		long bucket = strtol(p, &end, 10);
+		if (end == p || *end != ':' || bucket < 0 || bucket >= BUCKETS) return false;
+		p = end + 1;
+		unsigned long long n = strtoull(p, &end, 10);
+		if (end == p || (*end && *end != ' ')) return false;
+		decoded.buckets[bucket] += n;
+		decoded.total += n;
+		p = *end ? end + 1 : end;
+	}
+	merge(decoded);
+	return true;
+}
+
+static std::map<std::string, LatencyHistogram*>& namedHistograms() {
+	static std::map<std::string, LatencyHistogram*>* histograms = new std::map<std::string, LatencyHistogram*>;
+	return *histograms;
+}
+
+LatencyHistogram& LatencyHistogram::named(std::string const& name) {
+	auto& h = namedHistograms()[name];
+	if (!h) h = new LatencyHistogram;
+	return *h;
+}
+
+void LatencyHistogram::logAll() {
+	// Every request type has to be in the event for the cluster wide histograms to be complete, so it can't be
+	// truncated
+	TraceEvent metrics("LatencyHistogramMetrics");
+	metrics.setMaxEventLength(-1);
+	for (auto& it : namedHistograms()) {
+		auto const& name = it.first;
+		LatencyHistogram& h = *it.second;
+		if (!h.count()) continue;
+		std::string encoded = h.encode();
+		TraceEvent("LatencyHistogram")
+		    .detail("Name", name)
+		    .detail("Count", h.count())
+		    .detail("P50", h.percentile(0.5))
+		    .detail("P99", h.percentile(0.99))
+		    .detail("P999", h.percentile(0.999))
+		    .detail("Buckets", encoded);
+		metrics.detail((METRICS_DETAIL_PREFIX + name).c_str(), encoded);
+		h.clear();
+	}
+	metrics.trackLatest("LatencyHistogramMetrics");
+}
+
+TEST_CASE("/flow/LatencyHistogram/buckets") {
+	for (uint64_t micros : { 0ull, 1ull, 3ull, 4ull, 5ull, 7ull, 8ull, 1000ull, 123456ull, 1ull << 27 }) {
+		int bucket = LatencyHistogram::bucketFor(micros);
+		ASSERT(bucket >= 0 && bucket < LatencyHistogram::BUCKETS);
+		ASSERT(micros * 1e-6 < LatencyHistogram::bucketUpperBound(bucket));
+		ASSERT(bucket == 0 || micros * 1e-6 >= LatencyHistogram::bucketUpperBound(bucket - 1));
+	}
+	ASSERT(LatencyHistogram::bucketFor(uint64_t(1) << 40) == LatencyHistogram::BUCKETS - 1);
+
+	LatencyHistogram a, b;
+	for (int i = 0; i < 1000; i++) a.addMeasurement(i * 1e-4);
+	b.addMeasurement(10.0);
+	ASSERT(b.mergeEncoded(a.encode()));
+	ASSERT(b.count() == 1001);
+	ASSERT(b.percentile(0.5) >= 0.05 && b.percentile(0.5) <= 0.05 * 1.25);
+	ASSERT(b.percentile(1.0) >= 10.0);
+	ASSERT(!b.mergeEncoded("3:"));
+
+	return Void();
+}
@@ -0,0 +1,80 @@
+/*
+ * Histogram.h
+ *
+ * This source file is part of the FoundationDB open source project
+ *
+ * Copyright 2013-2018 Apple Inc. and the FoundationDB project authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLOW_HISTOGRAM_H
+#define FLOW_HISTOGRAM_H
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// A log-bucketed latency histogram in the style of HdrHistogram.  Measurements are kept in microseconds, each power
+// of two is split into SUB_BUCKETS linear buckets (so a bucket is at most 25% wide), and anything above about four
+// minutes lands in the last bucket.  Recording a measurement is a few shifts and an increment, so histograms can be
+// left on for every request.  Bucket boundaries are the same for every histogram, so histograms from different
+// processes can be merged by adding their buckets, which is what the encoded form is for.
+//
+// Histograms are not thread safe; they are meant to be recorded into and read from the network thread only.
+class LatencyHistogram {
+public:
+	enum { SUB_BUCKET_BITS = 2, SUB_BUCKETS = 1 << SUB_BUCKET_BITS, MAX_EXPONENT = 27 };
+	enum { BUCKETS = SUB_BUCKETS * (MAX_EXPONENT - SUB_BUCKET_BITS + 2) };
+
+	LatencyHistogram() { clear(); }
+
+	void addMeasurement(double seconds) {
+		uint64_t micros = seconds > 0 ? uint64_t(seconds * 1e6) : 0;
+		buckets[bucketFor(micros)]++;
+		total++;
+	}
+
+	void merge(LatencyHistogram const& other);
+	void clear();
+
+	uint64_t count() const { return total; }
+
+	// Returns the upper bound (in seconds) of the bucket containing the given fraction of the measurements
+	double percentile(double fraction) const;
+
+	// A compact "index:count index:count ..." encoding of the non-empty buckets
+	std::string encode() const;
+	// Adds the buckets in an encoding produced by encode() to this histogram; returns false if it is malformed
+	bool mergeEncoded(std::string const& encoded);
+
+	static int bucketFor(uint64_t micros);
+	static double bucketUpperBound(int bucket); // In seconds
+
+	// Returns the process wide histogram with the given name, creating it if necessary.  The reference remains valid
+	// for the life of the process.
+	static LatencyHistogram& named(std::string const& name);
+
+	// Logs a LatencyHistogram trace event for each named histogram that recorded anything since the last call, then
+	// clears them.  All of them are also written to a LatencyHistogramMetrics event for status, each as a detail
+	// named METRICS_DETAIL_PREFIX followed by the histogram's name.
+	static void logAll();
+	static constexpr const char* METRICS_DETAIL_PREFIX = "Latency_";
+
+private:
+	uint32_t buckets[BUCKETS];
+	uint64_t total;
+};
+
+#endif
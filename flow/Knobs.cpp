@@ -124,6 +124,7 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	init( SLOW_LOOP_CUTOFF,                          15.0 / 1000.0 );
 	init( SLOW_LOOP_SAMPLING_RATE,                             0.1 );
 	init( TSC_YIELD_TIME,                                  1000000 );
+	init( ACTOR_PROFILER_LOGGED_ACTORS,                         20 );
 	init( CERT_FILE_MAX_SIZE,                      5 * 1024 * 1024 );
 
 	//Network
@@ -135,6 +136,8 @@ FlowKnobs::FlowKnobs(bool randomize, bool isSimulated) {
 	init( MIN_PACKET_BUFFER_FREE_BYTES,                        256 );
 	init( FLOW_TCP_NODELAY,                                      1 );
 	init( FLOW_TCP_QUICKACK,                                     0 );
+	init( FLOW_LOCAL_SOCKETS,                                    0 );
+	init( FLOW_LOCAL_SOCKET_DIR,                                "" );
 	init( UNRESTRICTED_HANDSHAKE_LIMIT,                         15 );
 	init( BOUNDED_HANDSHAKE_LIMIT,                             400 );
 
@@ -143,6 +143,7 @@ public:
 	double SLOW_LOOP_CUTOFF;
 	double SLOW_LOOP_SAMPLING_RATE;
 	int64_t TSC_YIELD_TIME;
+	int ACTOR_PROFILER_LOGGED_ACTORS;
 	int64_t REACTOR_FLAGS;
 	int CERT_FILE_MAX_SIZE;
 
@@ -155,6 +156,8 @@ public:
 	int MIN_PACKET_BUFFER_FREE_BYTES;
 	int FLOW_TCP_NODELAY;
 	int FLOW_TCP_QUICKACK;
+	int FLOW_LOCAL_SOCKETS; // Listeners also accept, and connections to processes on the same machine prefer, Unix domain sockets in FLOW_LOCAL_SOCKET_DIR
+	std::string FLOW_LOCAL_SOCKET_DIR; // Must be private to the user the processes run as; created with mode 0700 if missing
 	int UNRESTRICTED_HANDSHAKE_LIMIT;
 	int BOUNDED_HANDSHAKE_LIMIT;
 
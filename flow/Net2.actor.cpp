@@ -38,6 +38,13 @@
 #include "flow/Profiler.h"
 #include "flow/ProtocolVersion.h"
 #include "flow/TLSPolicy.h"
+#include "flow/UnitTest.h"
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+#include <set>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #ifdef WIN32
 #include <mmsystem.h>
@@ -459,6 +466,231 @@ private:
 	}
 };
 
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+typedef boost::asio::local::stream_protocol::socket local_socket;
+typedef boost::asio::local::stream_protocol::acceptor local_acceptor;
+
+// The Unix domain socket that a process listening on addr also accepts connections on
+static std::string localSocketPath( std::string const& dir, NetworkAddress const& addr ) {
+	return joinPath( dir, format("fdb-%s.sock", NetworkAddress(addr.ip, addr.port).toString().c_str()) );
+}
+
+// Local sockets are only used in a directory owned by this user that no one else can write to, so that another user on
+// the machine cannot put a socket of their own where a client expects a server's
+static bool isPrivateLocalSocketDir( std::string const& dir ) {
+	struct stat st;
+	return !dir.empty() && ::lstat( dir.c_str(), &st ) == 0 && S_ISDIR(st.st_mode) && st.st_uid == ::geteuid() &&
+	       !(st.st_mode & (S_IWGRP | S_IWOTH));
+}
+
+// A Unix domain socket has no peer address that FlowTransport could tell apart from the others, so each incoming local
+// connection is given the listener's IP and a port that no live local connection to the same listener is using.  The
+// ports are below 1024, so they are never mistaken for the ephemeral port of an incoming TCP connection.
+struct LocalPeerPorts : ReferenceCounted<LocalPeerPorts> {
+	enum { FIRST_PORT = 1, LAST_PORT = 1023 };
+	std::set<uint16_t> inUse;
+	uint16_t next;
+
+	LocalPeerPorts() : next(FIRST_PORT) {}
+
+	// Returns 0 if every port is in use
+	uint16_t acquire() {
+		for(int i = FIRST_PORT; i <= LAST_PORT; i++) {
+			uint16_t port = next;
+			next = next == LAST_PORT ? FIRST_PORT : next + 1;
+			if(inUse.insert(port).second)
+				return port;
+		}
+		return 0;
+	}
+	void release( uint16_t port ) { inUse.erase(port); }
+};
+
+// A connection to another process on this machine through a Unix domain socket.  It carries the same bytes as a TCP
+// Connection, but they do not go through the TCP/IP stack.
+class LocalConnection : public IConnection, ReferenceCounted<LocalConnection> {
+public:
+	virtual void addref() { ReferenceCounted<LocalConnection>::addref(); }
+	virtual void delref() { ReferenceCounted<LocalConnection>::delref(); }
+
+	virtual void close() {
+		closeSocket();
+	}
+
+	explicit LocalConnection( boost::asio::io_service& io_service )
+		: id(nondeterministicRandom()->randomUniqueID()), socket(io_service), localPeerPort(0)
+	{
+	}
+
+	~LocalConnection() {
+		if(localPeerPort)
+			localPeerPorts->release(localPeerPort);
+	}
+
+	// Returns true if the process listening on addr appears to accept local connections in dir
+	static bool isAvailable( std::string const& dir, NetworkAddress const& addr ) {
+		struct stat st;
+		return isPrivateLocalSocketDir(dir) && ::lstat( localSocketPath(dir, addr).c_str(), &st ) == 0 &&
+		       S_ISSOCK(st.st_mode) && st.st_uid == ::geteuid();
+	}
+
+	// This is not part of the IConnection interface, because it is wrapped by INetwork::connect()
+	ACTOR static Future<Reference<IConnection>> connect( boost::asio::io_service* ios, std::string dir, NetworkAddress addr ) {
+		state Reference<LocalConnection> self( new LocalConnection(*ios) );
+
+		self->peer_address = addr;
+		try {
+			BindPromise p("N2_LocalConnectError", self->id);
+			Future<Void> onConnected = p.getFuture();
+			self->socket.async_connect( boost::asio::local::stream_protocol::endpoint(localSocketPath(dir, addr)), std::move(p) );
+
+			wait( onConnected );
+			if (!self->peerIsThisUser()) {
+				TraceEvent(SevWarnAlways, "N2_LocalPeerNotTrusted", self->id).suppressFor(1.0).detail("PeerAddr", addr).detail("Directory", dir);
+				throw connection_failed();
+			}
+			self->init();
+			return self;
+		} catch (Error&) {
+			// Either the connection failed, or was cancelled by the caller
+			self->closeSocket();
+			throw;
+		}
+	}
+
+	// This is not part of the IConnection interface, because it is wrapped by IListener::accept()
+	void accept( NetworkAddress peerAddr, Reference<LocalPeerPorts> ports ) {
+		this->peer_address = peerAddr;
+		localPeerPorts = ports;
+		localPeerPort = peerAddr.port;
+		init();
+	}
+
+	virtual Future<Void> acceptHandshake() { return Void(); }
+
+	virtual Future<Void> connectHandshake() { return Void(); }
+
+	virtual Future<Void> onWritable() {
+		++g_net2->countWriteProbes;
+		BindPromise p("N2_WriteProbeError", id);
+		auto f = p.getFuture();
+		socket.async_write_some( boost::asio::null_buffers(), std::move(p) );
+		return f;
+	}
+
+	virtual Future<Void> onReadable() {
+		++g_net2->countReadProbes;
+		BindPromise p("N2_ReadProbeError", id);
+		auto f = p.getFuture();
+		socket.async_read_some( boost::asio::null_buffers(), std::move(p) );
+		return f;
+	}
+
+	virtual int read( uint8_t* begin, uint8_t* end ) {
+		boost::system::error_code err;
+		++g_net2->countReads;
+		size_t size = socket.read_some( boost::asio::mutable_buffers_1(begin, end-begin), err );
+		g_net2->bytesReceived += size;
+		if (err) {
+			if (err == boost::asio::error::would_block) {
+				++g_net2->countWouldBlock;
+				return 0;
+			}
+			onError("N2_ReadError", err);
+			throw connection_failed();
+		}
+		ASSERT( size );  // If the socket is closed, we expect an 'eof' error, not a zero return value
+
+		return size;
+	}
+
+	virtual int write( SendBuffer const* data, int limit ) {
+		boost::system::error_code err;
+		++g_net2->countWrites;
+
+		// Gather the chain up to the limit into one scatter/gather write
+		boost::asio::const_buffer buffers[64];
+		int count = 0;
+		for(auto p = data; p && limit > 0 && count < 64; p = p->next) {
+			int len = std::min(limit, p->bytes_written - p->bytes_sent);
+			buffers[count++] = boost::asio::const_buffer( p->data + p->bytes_sent, len );
+			limit -= len;
+		}
+
+		size_t sent = socket.write_some( boost::asio::buffer(buffers, count), err );
+
+		if (err) {
+			if (err == boost::asio::error::would_block) {
+				++g_net2->countWouldBlock;
+				return 0;
+			}
+			onError("N2_WriteError", err);
+			throw connection_failed();
+		}
+
+		ASSERT( sent );
+		return sent;
+	}
+
+	virtual NetworkAddress getPeerAddress() { return peer_address; }
+
+	virtual UID getDebugID() { return id; }
+
+	local_socket& getSocket() { return socket; }
+
+private:
+	UID id;
+	local_socket socket;
+	NetworkAddress peer_address;
+	Reference<LocalPeerPorts> localPeerPorts;
+	uint16_t localPeerPort;
+
+	void init() {
+		socket.non_blocking(true);
+		platform::setCloseOnExec(socket.native_handle());
+	}
+
+	// Returns true if the process at the other end of the socket runs as this user
+	bool peerIsThisUser() {
+#ifdef __linux__
+		struct ucred cred;
+		socklen_t len = sizeof(cred);
+		if (::getsockopt( socket.native_handle(), SOL_SOCKET, SO_PEERCRED, &cred, &len ) != 0) return false;
+		return cred.uid == ::geteuid();
+#else
+		uid_t uid;
+		gid_t gid;
+		if (::getpeereid( socket.native_handle(), &uid, &gid ) != 0) return false;
+		return uid == ::geteuid();
+#endif
+	}
+
+	void closeSocket() {
+		boost::system::error_code error;
+		socket.close(error);
+		if (error)
+			TraceEvent(SevWarn, "N2_CloseError", id).suppressFor(1.0).detail("ErrorCode", error.value()).detail("Message", error.message());
+	}
+
+	void onError( const char* type, const boost::system::error_code& error ) {
+		TraceEvent(SevWarn, type, id).suppressFor(1.0).detail("ErrorCode", error.value()).detail("Message", error.message()).detail("Local", true);
+		closeSocket();
+	}
+};
+
+// Connects through the listener's Unix domain socket if it has one, and falls back to TCP if that fails
+ACTOR static Future<Reference<IConnection>> connectLocalOrTCP( boost::asio::io_service* ios, std::string dir, NetworkAddress addr ) {
+	try {
+		Reference<IConnection> conn = wait( LocalConnection::connect(ios, dir, addr) );
+		return conn;
+	} catch (Error& e) {
+		if (e.code() == error_code_actor_cancelled) throw;
+	}
+	Reference<IConnection> conn = wait( Connection::connect(ios, addr) );
+	return conn;
+}
+#endif
+
 class Listener : public IListener, ReferenceCounted<Listener> {
 	NetworkAddress listenAddress;
 	tcp::acceptor acceptor;
@@ -475,12 +707,108 @@ public:
 
 	// Returns one incoming connection when it is available
 	virtual Future<Reference<IConnection>> accept() {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		if(localAcceptor) {
+			return acceptEither( this );
+		}
+#endif
 		return doAccept( this );
 	}
 
 	virtual NetworkAddress getListenAddress() { return listenAddress; }
 
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	// Also accept connections from processes on this machine through a Unix domain socket in dir.  Only called once the
+	// TCP port is bound, so any socket file already at the path was left behind by a previous process on the same address.
+	void listenLocal( std::string const& dir ) {
+		if (!dir.empty() && ::mkdir( dir.c_str(), 0700 ) == 0) {
+			TraceEvent("N2_CreatedLocalSocketDir").detail("Directory", dir);
+		}
+		if (!isPrivateLocalSocketDir(dir)) {
+			TraceEvent(SevWarnAlways, "N2_LocalSocketDirNotPrivate").detail("Address", listenAddress).detail("Directory", dir);
+			return;
+		}
+
+		std::string path = localSocketPath( dir, listenAddress );
+		if (::unlink( path.c_str() ) != 0 && errno != ENOENT) {
+			TraceEvent(SevWarnAlways, "N2_ListenLocalError").GetLastError().detail("Address", listenAddress).detail("Path", path);
+			return;
+		}
+		try {
+			localAcceptor.reset( new local_acceptor( acceptor.get_io_service(), boost::asio::local::stream_protocol::endpoint(path) ) );
+			platform::setCloseOnExec(localAcceptor->native_handle());
+			localPath = path;
+			localPeerPorts = Reference<LocalPeerPorts>( new LocalPeerPorts );
+			TraceEvent("N2_ListenLocal").detail("Address", listenAddress).detail("Path", path);
+		} catch (boost::system::system_error const& e) {
+			TraceEvent(SevWarnAlways, "N2_ListenLocalError").detail("Address", listenAddress).detail("Path", path).detail("Message", e.what());
+			localAcceptor.reset();
+			// Don't leave anything at the path for clients to try before TCP
+			::unlink( path.c_str() );
+		}
+	}
+
+	~Listener() {
+		pendingAccept = Future<Reference<IConnection>>();
+		pendingLocalAccept = Future<Reference<IConnection>>();
+		if(!localPath.empty())
+			::unlink( localPath.c_str() );
+	}
+#endif
+
 private:
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	std::unique_ptr<local_acceptor> localAcceptor;
+	std::string localPath;
+	Reference<LocalPeerPorts> localPeerPorts;
+	// An accept from each acceptor stays outstanding between calls to accept(), until it is returned
+	Future<Reference<IConnection>> pendingAccept, pendingLocalAccept;
+
+	ACTOR static Future<Reference<IConnection>> acceptEither( Listener* self ) {
+		if(!self->pendingAccept.isValid())
+			self->pendingAccept = doAccept( self );
+		if(!self->pendingLocalAccept.isValid())
+			self->pendingLocalAccept = doAcceptLocal( self );
+
+		choose {
+			when( Reference<IConnection> conn = wait( self->pendingAccept ) ) {
+				self->pendingAccept = Future<Reference<IConnection>>();
+				return conn;
+			}
+			when( Reference<IConnection> conn = wait( self->pendingLocalAccept ) ) {
+				self->pendingLocalAccept = Future<Reference<IConnection>>();
+				return conn;
+			}
+		}
+	}
+
+	ACTOR static Future<Reference<IConnection>> doAcceptLocal( Listener* self ) {
+		loop {
+			state Reference<LocalConnection> conn( new LocalConnection( self->acceptor.get_io_service() ) );
+			try {
+				BindPromise p("N2_LocalAcceptError", UID());
+				auto f = p.getFuture();
+				self->localAcceptor->async_accept( conn->getSocket(), std::move(p) );
+				wait( f );
+			} catch (Error& e) {
+				conn->close();
+				if (e.code() == error_code_actor_cancelled) throw;
+				// The TCP acceptor keeps working, so stop accepting local connections rather than failing the listener
+				TraceEvent(SevWarnAlways, "N2_LocalListenerFailed").error(e).detail("Address", self->listenAddress);
+				wait( Never() );
+			}
+
+			uint16_t port = self->localPeerPorts->acquire();
+			if(port) {
+				conn->accept( NetworkAddress(self->listenAddress.ip, port), self->localPeerPorts );
+				return conn;
+			}
+			TraceEvent(SevWarnAlways, "N2_TooManyLocalConnections").suppressFor(1.0).detail("Address", self->listenAddress);
+			conn->close();
+		}
+	}
+#endif
+
 	ACTOR static Future<Reference<IConnection>> doAccept( Listener* self ) {
 		state Reference<Connection> conn( new Connection( self->acceptor.get_io_service() ) );
 		state tcp::acceptor::endpoint_type peer_endpoint;
@@ -1355,6 +1683,12 @@ Future< Reference<IConnection> > Net2::connect( NetworkAddress toAddr, std::stri
 	}
 #endif
 
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+	if ( FLOW_KNOBS->FLOW_LOCAL_SOCKETS && !FLOW_KNOBS->FLOW_LOCAL_SOCKET_DIR.empty() && isAddressOnThisHost(toAddr) && LocalConnection::isAvailable(FLOW_KNOBS->FLOW_LOCAL_SOCKET_DIR, toAddr) ) {
+		return connectLocalOrTCP(&this->reactor.ios, FLOW_KNOBS->FLOW_LOCAL_SOCKET_DIR, toAddr);
+	}
+#endif
+
 	return Connection::connect(&this->reactor.ios, toAddr);
 }
 
@@ -1434,7 +1768,13 @@ Reference<IListener> Net2::listen( NetworkAddress localAddr ) {
 			return Reference<IListener>(new SSLListener( reactor.ios, &this->sslContext, localAddr ));
 		}
 #endif
-		return Reference<IListener>( new Listener( reactor.ios, localAddr ) );
+		Reference<Listener> listener( new Listener( reactor.ios, localAddr ) );
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+		if ( FLOW_KNOBS->FLOW_LOCAL_SOCKETS && !FLOW_KNOBS->FLOW_LOCAL_SOCKET_DIR.empty() && localAddr.port ) {
+			listener->listenLocal( FLOW_KNOBS->FLOW_LOCAL_SOCKET_DIR );
+		}
+#endif
+		return listener;
 	} catch (boost::system::system_error const& e) {
 		Error x;
 		if(e.code().value() == EADDRINUSE)
@@ -1529,6 +1869,90 @@ void ASIOReactor::wake() {
 	ios.post( nullCompletionHandler );
 }
 
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+// Sends a few bytes from one end of a connection and checks that they arrive at the other
+ACTOR static Future<Void> checkConnectionCarriesData( Reference<IConnection> from, Reference<IConnection> to ) {
+	state std::string sent = "local socket test";
+	state std::string received;
+	{
+		SendBuffer buffer;
+		buffer.data = (const uint8_t*)sent.data();
+		buffer.next = nullptr;
+		buffer.bytes_written = sent.size();
+		buffer.bytes_sent = 0;
+		ASSERT( from->write( &buffer, sent.size() ) == sent.size() ); // A new connection has room for a few bytes
+	}
+	loop {
+		{
+			uint8_t data[64];
+			int n = to->read( data, data + sizeof(data) );
+			received.append( (const char*)data, n );
+		}
+		if (received.size() >= sent.size()) break;
+		wait( to->onReadable() );
+	}
+	ASSERT( received == sent );
+	return Void();
+}
+
+TEST_CASE("/flow/Net2/LocalConnection") {
+	// Local sockets are only part of the real network
+	if (g_network->isSimulated()) return Void();
+
+	state std::string dir = "/tmp/fdb-local-socket-test-XXXXXX";
+	ASSERT( ::mkdtemp( &dir[0] ) != nullptr ); // Created with mode 0700
+	state NetworkAddress addr;
+	{
+		tcp::acceptor probe( g_net2->reactor.ios, tcp::endpoint( boost::asio::ip::address_v4::loopback(), 0 ) );
+		addr = NetworkAddress( IPAddress(0x7f000001), probe.local_endpoint().port() );
+	}
+	state std::string path = localSocketPath( dir, addr );
+
+	// Connect and accept through the listener's local socket
+	state Reference<Listener> listener( new Listener( g_net2->reactor.ios, addr ) );
+	listener->listenLocal( dir );
+	ASSERT( LocalConnection::isAvailable( dir, addr ) );
+	state Future<Reference<IConnection>> accepted = listener->accept();
+	state Reference<IConnection> client = wait( connectLocalOrTCP( &g_net2->reactor.ios, dir, addr ) );
+	state Reference<IConnection> server = wait( accepted );
+	ASSERT( server->getPeerAddress().port < 1024 ); // Local connections are given ports below any TCP peer's
+	wait( checkConnectionCarriesData( client, server ) );
+	wait( checkConnectionCarriesData( server, client ) );
+
+	// Sockets in a directory other users can write to are not trusted
+	ASSERT( ::chmod( dir.c_str(), 0777 ) == 0 );
+	ASSERT( !LocalConnection::isAvailable( dir, addr ) );
+	ASSERT( ::chmod( dir.c_str(), 0700 ) == 0 );
+
+	// A socket left behind by a listener that is gone falls back to TCP
+	client->close();
+	server->close();
+	client = Reference<IConnection>();
+	server = Reference<IConnection>();
+	accepted = Future<Reference<IConnection>>();
+	listener = Reference<Listener>();
+	ASSERT( !LocalConnection::isAvailable( dir, addr ) ); // The listener removes its socket
+	{
+		local_acceptor stale( g_net2->reactor.ios, boost::asio::local::stream_protocol::endpoint( path ) );
+	}
+	ASSERT( LocalConnection::isAvailable( dir, addr ) );
+	listener = Reference<Listener>( new Listener( g_net2->reactor.ios, addr ) );
+	accepted = listener->accept();
+	Reference<IConnection> tcpClient = wait( connectLocalOrTCP( &g_net2->reactor.ios, dir, addr ) );
+	client = tcpClient;
+	Reference<IConnection> tcpServer = wait( accepted );
+	server = tcpServer;
+	ASSERT( server->getPeerAddress().port >= 1024 );
+	wait( checkConnectionCarriesData( client, server ) );
+
+	client->close();
+	server->close();
+	::unlink( path.c_str() );
+	::rmdir( dir.c_str() );
+	return Void();
+}
+#endif
+
 } // namespace net2
 
 INetwork* newNet2(bool useThreadPool, bool useMetrics, Reference<TLSPolicy> policy, const TLSParams& tlsParams) {
@@ -20,6 +20,7 @@
 
 #include "flow/flow.h"
 #include "flow/Platform.h"
+#include "flow/Histogram.h"
 #include "flow/TDMetric.actor.h"
 #include "flow/SystemMonitor.h"
 
@@ -39,6 +40,7 @@ void initializeSystemMonitorMachineState(SystemMonitorMachineState machineState)
 void systemMonitor() {
 	static StatisticsState statState = StatisticsState();
 	customSystemMonitor("ProcessMetrics", &statState, true );
+	LatencyHistogram::logAll();
 }
 
 SystemStatistics getSystemStatistics() {
@@ -117,6 +119,9 @@ SystemStatistics customSystemMonitor(std::string eventName, StatisticsState *sta
 				.DETAILALLOCATORMEMUSAGE(8192)
 				.detail("HugeArenaMemory", g_hugeArenaMemory.load());
 
+			// Only has anything to report in builds where the actor compiler generated profiling scopes
+			logActorProfiles();
+
 			TraceEvent n("NetworkMetrics");
 			n
 				.detail("Elapsed", currentStats.elapsed)
@@ -37,6 +37,7 @@
 #include "flow/EventTypes.actor.h"
 #include "flow/TDMetric.actor.h"
 #include "flow/MetricSample.h"
+#include "flow/UnitTest.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -402,16 +403,16 @@ public:
 			return;
 		}
 
-		// FIXME: What if we are using way too much memory for buffer?
-		eventBuffer.push_back(fields);
-		bufferLength += fields.sizeBytes();
-
 		if(trackError) {
 			latestEventCache.setLatestError(fields);
 		}
 		if(!trackLatestKey.empty()) {
 			latestEventCache.set(trackLatestKey, fields);
 		}
+
+		// FIXME: What if we are using way too much memory for buffer?
+		bufferLength += fields.sizeBytes();
+		eventBuffer.push_back(std::move(fields));
 	}
 
 	void log(int severity, const char *name, UID id, uint64_t event_ts)
@@ -1083,7 +1084,7 @@ void TraceEvent::log() {
 					TraceEvent::eventCounts[severity/10]++;
 				}
 
-				g_traceLog.writeEvent( fields, trackingKey, severity > SevWarnAlways );
+				g_traceLog.writeEvent( std::move(fields), trackingKey, severity > SevWarnAlways );
 
 				if (g_traceLog.isOpen()) {
 					// Log Metrics
@@ -1177,21 +1178,21 @@ void TraceBatch::dump() {
 		if(g_network->isSimulated()) {
 			attachBatch[i].fields.addField("Machine", machine);
 		}
-		g_traceLog.writeEvent(attachBatch[i].fields, "", false);
+		g_traceLog.writeEvent(std::move(attachBatch[i].fields), "", false);
 	}
 
 	for(int i = 0; i < eventBatch.size(); i++) {
 		if(g_network->isSimulated()) {
 			eventBatch[i].fields.addField("Machine", machine);
 		}
-		g_traceLog.writeEvent(eventBatch[i].fields, "", false);
+		g_traceLog.writeEvent(std::move(eventBatch[i].fields), "", false);
 	}
 
 	for(int i = 0; i < buggifyBatch.size(); i++) {
 		if(g_network->isSimulated()) {
 			buggifyBatch[i].fields.addField("Machine", machine);
 		}
-		g_traceLog.writeEvent(buggifyBatch[i].fields, "", false);
+		g_traceLog.writeEvent(std::move(buggifyBatch[i].fields), "", false);
 	}
 
 	g_traceLog.flush();
@@ -1421,3 +1422,20 @@ std::string traceableStringToString(const char* value, size_t S) {
 
 	return std::string(value, S - 1); // Exclude trailing \0 byte
 }
+
+TEST_CASE("/flow/Trace/traceableIntegers") {
+	ASSERT(Traceable<int>::toString(0) == "0");
+	ASSERT(Traceable<int>::toString(std::numeric_limits<int>::min()) == format("%d", std::numeric_limits<int>::min()));
+	ASSERT(Traceable<unsigned long long>::toString(std::numeric_limits<unsigned long long>::max()) == format("%llu", std::numeric_limits<unsigned long long>::max()));
+	ASSERT(Traceable<long long>::toString(-1234567890123LL) == "-1234567890123");
+	ASSERT(Traceable<bool>::toString(true) == "1" && Traceable<bool>::toString(false) == "0");
+	ASSERT(Traceable<unsigned char>::toString(255) == "255");
+
+	for (int i = 0; i < 100; i++) {
+		UID id = deterministicRandom()->randomUniqueID();
+		ASSERT(Traceable<UID>::toString(id) == format("%016llx", id.first()));
+	}
+	ASSERT(Traceable<UID>::toString(UID(1, 0)) == "0000000000000001");
+
+	return Void();
+}
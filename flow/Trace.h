@@ -23,6 +23,7 @@
 #pragma once
 
 #include <atomic>
+#include <charconv>
 #include <stdarg.h>
 #include <stdint.h>
 #include <string>
@@ -203,30 +204,56 @@ struct Traceable : std::false_type {};
 		}											\
 	}
 
-FORMAT_TRACEABLE(bool, "%d");
-FORMAT_TRACEABLE(signed char, "%d");
-FORMAT_TRACEABLE(unsigned char, "%d");
-FORMAT_TRACEABLE(short, "%d");
-FORMAT_TRACEABLE(unsigned short, "%d");
-FORMAT_TRACEABLE(int, "%d");
-FORMAT_TRACEABLE(unsigned, "%u");
-FORMAT_TRACEABLE(long int, "%ld");
-FORMAT_TRACEABLE(unsigned long int, "%lu");
-FORMAT_TRACEABLE(long long int, "%lld");
-FORMAT_TRACEABLE(unsigned long long int, "%llu");
+// Details are formatted by the thread logging the event, so integers, which are most of them, skip printf
+template<class T>
+std::string traceableIntegerToString(T value) {
+	char buf[24];
+	return std::string(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+}
+
+#define INTEGER_TRACEABLE(type)							\
+	template<>											\
+	struct Traceable<type> : std::true_type {			\
+		static std::string toString(type value) {		\
+			return traceableIntegerToString(value);		\
+		}												\
+	}
+
+template<>
+struct Traceable<bool> : std::true_type {
+	static std::string toString(bool value) {
+		return value ? "1" : "0";
+	}
+};
+
+INTEGER_TRACEABLE(signed char);
+INTEGER_TRACEABLE(unsigned char);
+INTEGER_TRACEABLE(short);
+INTEGER_TRACEABLE(unsigned short);
+INTEGER_TRACEABLE(int);
+INTEGER_TRACEABLE(unsigned);
+INTEGER_TRACEABLE(long int);
+INTEGER_TRACEABLE(unsigned long int);
+INTEGER_TRACEABLE(long long int);
+INTEGER_TRACEABLE(unsigned long long int);
 FORMAT_TRACEABLE(double, "%g");
 FORMAT_TRACEABLE(void*, "%p");
-FORMAT_TRACEABLE(volatile long, "%ld");
-FORMAT_TRACEABLE(volatile unsigned long, "%lu");
-FORMAT_TRACEABLE(volatile long long, "%lld");
-FORMAT_TRACEABLE(volatile unsigned long long, "%llu");
+INTEGER_TRACEABLE(volatile long);
+INTEGER_TRACEABLE(volatile unsigned long);
+INTEGER_TRACEABLE(volatile long long);
+INTEGER_TRACEABLE(volatile unsigned long long);
 FORMAT_TRACEABLE(volatile double, "%g");
 
 
 template<>
 struct Traceable<UID> : std::true_type {
 	static std::string toString(const UID& value) {
-		return format("%016llx", value.first());
+		std::string s(16, '0');
+		uint64_t v = value.first();
+		for (int i = 15; i >= 0; --i, v >>= 4) {
+			s[i] = "0123456789abcdef"[v & 0xf];
+		}
+		return s;
 	}
 };
 
@@ -425,7 +452,7 @@ struct TraceEvent {
 	detail(const char* key, T value) {
 		if (enabled && init()) {
 			setField(key, int64_t(value));
-			return detailImpl(std::string(key), format("%d", value), false);
+			return detailImpl(std::string(key), traceableIntegerToString(int64_t(value)), false);
 		}
 		return *this;
 	}
@@ -284,14 +284,16 @@ namespace actorcompiler
         int chooseGroups = 0, whenCount = 0;
         string This;
         bool generateProbes;
+        bool generateProfiling;
 
-        public ActorCompiler(Actor actor, string sourceFile, bool isTopLevel, bool lineNumbersEnabled, bool generateProbes)
+        public ActorCompiler(Actor actor, string sourceFile, bool isTopLevel, bool lineNumbersEnabled, bool generateProbes, bool generateProfiling)
         {
             this.actor = actor;
             this.sourceFile = sourceFile;
             this.isTopLevel = isTopLevel;
             this.LineNumbersEnabled = lineNumbersEnabled;
             this.generateProbes = generateProbes;
+            this.generateProfiling = generateProfiling;
 
             FindState();
         }
@@ -438,6 +440,12 @@ namespace actorcompiler
             if (generateProbes) {
                 fun.WriteLine("fdb_probe_actor_enter(\"{0}\", {1}, {2});", name, thisAddress, index);
             }
+            if (generateProfiling) {
+                // The scope is a local, so it is closed at the end of the enclosing function even if the actor has
+                // been destroyed by then
+                fun.WriteLine("static ActorProfile& actorProfile = ActorProfile::get(\"{0}\");", name);
+                fun.WriteLine("ActorProfilerScope actorProfilerScope(actorProfile);");
+            }
         }
 
         void ProbeExit(Function fun, string name, int index = -1) {
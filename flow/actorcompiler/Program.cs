@@ -31,10 +31,11 @@ namespace actorcompiler
         public static int Main(string[] args)
         {
             bool generateProbes = false;
+            bool generateProfiling = false;
             if (args.Length < 2)
             {
                 Console.WriteLine("Usage:");
-                Console.WriteLine("  actorcompiler <input> <output> [--disable-diagnostics] [--generate-probes]");
+                Console.WriteLine("  actorcompiler <input> <output> [--disable-diagnostics] [--generate-probes] [--generate-profiling]");
                 return 100;
             }
             Console.WriteLine("actorcompiler {0}", string.Join(" ", args));
@@ -46,6 +47,8 @@ namespace actorcompiler
                         errorMessagePolicy.DisableDiagnostics = true;
                     } else if (arg.Equals("--generate-probes")) {
                         generateProbes = true;
+                    } else if (arg.Equals("--generate-profiling")) {
+                        generateProfiling = true;
                     }
                 }
             }
@@ -53,7 +56,7 @@ namespace actorcompiler
             {
                 var inputData = File.ReadAllText(input);
                 using (var outputStream = new StreamWriter(outputtmp))
-                    new ActorParser(inputData, input.Replace('\\', '/'), errorMessagePolicy, generateProbes).Write(outputStream, output.Replace('\\', '/'));
+                    new ActorParser(inputData, input.Replace('\\', '/'), errorMessagePolicy, generateProbes, generateProfiling).Write(outputStream, output.Replace('\\', '/'));
                 if (File.Exists(output))
                 {
                     File.SetAttributes(output, FileAttributes.Normal);
@@ -45,6 +45,7 @@
 #include "flow/ThreadPrimitives.h"
 #include "flow/network.h"
 #include "flow/FileIdentifier.h"
+#include "flow/ActorProfiler.h"
 
 #include <boost/version.hpp>
 